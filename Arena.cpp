@@ -0,0 +1,17 @@
+#include "Arena.h"
+#include <algorithm>
+
+void Arena::grow(std::size_t minimum) {
+    // Blokken verdubbelen zodat ook grote grammatica's met weinig blokken toekomen
+    std::size_t size = std::max(minimum, blocks.empty() ? blockSize : std::min<std::size_t>(reserved, 64 << 20));
+    blocks.emplace_back(new char[size]);
+    cursor = blocks.back().get();
+    limit = cursor + size;
+    reserved += size;
+}
+
+void Arena::release() {
+    blocks.clear();
+    cursor = limit = nullptr;
+    reserved = 0;
+}
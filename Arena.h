@@ -0,0 +1,73 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Monotone geheugenpool: allocaties schuiven een cursor op in grote blokken en worden
+// nooit afzonderlijk vrijgegeven, enkel allemaal samen (release of destructor).
+// Verplaatsen is goedkoop en laat eerder uitgedeelde pointers geldig.
+class Arena {
+public:
+    explicit Arena(std::size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+    // De bron blijft leeg achter: zijn cursor wees in een blok dat nu van het doel is
+    Arena(Arena &&other) noexcept
+            : blocks(std::move(other.blocks)), cursor(other.cursor), limit(other.limit),
+              blockSize(other.blockSize), reserved(other.reserved) {
+        other.blocks.clear();
+        other.cursor = other.limit = nullptr;
+        other.reserved = 0;
+    }
+    Arena &operator=(Arena &&other) noexcept {
+        if (this != &other) {
+            blocks = std::move(other.blocks);
+            cursor = other.cursor;
+            limit = other.limit;
+            blockSize = other.blockSize;
+            reserved = other.reserved;
+            other.blocks.clear();
+            other.cursor = other.limit = nullptr;
+            other.reserved = 0;
+        }
+        return *this;
+    }
+    Arena(const Arena &) = delete;
+    Arena &operator=(const Arena &) = delete;
+
+    void *allocate(std::size_t bytes, std::size_t alignment = alignof(std::max_align_t)) {
+        std::size_t padding = (alignment - reinterpret_cast<std::uintptr_t>(cursor) % alignment) % alignment;
+        if (cursor == nullptr || static_cast<std::size_t>(limit - cursor) < padding + bytes) {
+            grow(bytes + alignment);
+            padding = (alignment - reinterpret_cast<std::uintptr_t>(cursor) % alignment) % alignment;
+        }
+        char *result = cursor + padding;
+        cursor = result + bytes;
+        return result;
+    }
+
+    // Kopie van een string in de pool; blijft geldig tot release()
+    std::string_view copy(std::string_view text) {
+        if (text.empty()) return {};
+        char *target = static_cast<char *>(allocate(text.size(), 1));
+        std::char_traits<char>::copy(target, text.data(), text.size());
+        return {target, text.size()};
+    }
+
+    void release();
+    std::size_t capacity() const { return reserved; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocks;
+    char *cursor = nullptr;
+    char *limit = nullptr;
+    std::size_t blockSize;
+    std::size_t reserved = 0;
+
+    void grow(std::size_t minimum);
+};
+
+#endif // ARENA_H
@@ -0,0 +1,181 @@
+#include "BitKernels.h"
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define BITKERNELS_X86 1
+#include <immintrin.h>
+#endif
+
+namespace {
+    void orScalar(std::uint64_t *target, const std::uint64_t *source, std::size_t words) {
+        for (std::size_t w = 0; w < words; ++w) target[w] |= source[w];
+    }
+
+    void andScalar(std::uint64_t *target, const std::uint64_t *source, std::size_t words) {
+        for (std::size_t w = 0; w < words; ++w) target[w] &= source[w];
+    }
+
+    std::size_t countScalar(const std::uint64_t *words, std::size_t length) {
+        std::size_t total = 0;
+        for (std::size_t w = 0; w < length; ++w) total += __builtin_popcountll(words[w]);
+        return total;
+    }
+
+    bool anyScalar(const std::uint64_t *words, std::size_t length) {
+        for (std::size_t w = 0; w < length; ++w) {
+            if (words[w]) return true;
+        }
+        return false;
+    }
+
+    const BitKernels scalarKernels{"scalar", orScalar, andScalar, countScalar, anyScalar};
+
+#ifdef BITKERNELS_X86
+    __attribute__((target("avx2"))) void orAVX2(std::uint64_t *target, const std::uint64_t *source,
+                                                 std::size_t words) {
+        std::size_t w = 0;
+        for (; w + 4 <= words; w += 4) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(target + w));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + w));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(target + w), _mm256_or_si256(a, b));
+        }
+        for (; w < words; ++w) target[w] |= source[w];
+    }
+
+    __attribute__((target("avx2"))) void andAVX2(std::uint64_t *target, const std::uint64_t *source,
+                                                  std::size_t words) {
+        std::size_t w = 0;
+        for (; w + 4 <= words; w += 4) {
+            __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(target + w));
+            __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(source + w));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(target + w), _mm256_and_si256(a, b));
+        }
+        for (; w < words; ++w) target[w] &= source[w];
+    }
+
+    // Popcount per nibble met een opzoektabel in pshufb, opgeteld per 64-bit lane met psadbw
+    __attribute__((target("avx2,popcnt"))) std::size_t countAVX2(const std::uint64_t *words, std::size_t length) {
+        const __m256i table = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                               0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+        const __m256i low = _mm256_set1_epi8(0x0f);
+        __m256i sums = _mm256_setzero_si256();
+        std::size_t w = 0;
+        for (; w + 4 <= length; w += 4) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + w));
+            __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(table, _mm256_and_si256(v, low)),
+                                             _mm256_shuffle_epi8(table, _mm256_and_si256(_mm256_srli_epi16(v, 4), low)));
+            sums = _mm256_add_epi64(sums, _mm256_sad_epu8(counts, _mm256_setzero_si256()));
+        }
+        std::size_t total = static_cast<std::size_t>(_mm256_extract_epi64(sums, 0) + _mm256_extract_epi64(sums, 1) +
+                                                     _mm256_extract_epi64(sums, 2) + _mm256_extract_epi64(sums, 3));
+        for (; w < length; ++w) total += _mm_popcnt_u64(words[w]);
+        return total;
+    }
+
+    __attribute__((target("avx2"))) bool anyAVX2(const std::uint64_t *words, std::size_t length) {
+        std::size_t w = 0;
+        for (; w + 4 <= length; w += 4) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(words + w));
+            if (!_mm256_testz_si256(v, v)) return true;
+        }
+        for (; w < length; ++w) {
+            if (words[w]) return true;
+        }
+        return false;
+    }
+
+    __attribute__((target("avx512f"))) void orAVX512(std::uint64_t *target, const std::uint64_t *source,
+                                                      std::size_t words) {
+        std::size_t w = 0;
+        for (; w + 8 <= words; w += 8) {
+            __m512i a = _mm512_loadu_si512(target + w);
+            __m512i b = _mm512_loadu_si512(source + w);
+            _mm512_storeu_si512(target + w, _mm512_or_si512(a, b));
+        }
+        if (w < words) {
+            const __mmask8 mask = static_cast<__mmask8>((1u << (words - w)) - 1);
+            __m512i a = _mm512_maskz_loadu_epi64(mask, target + w);
+            __m512i b = _mm512_maskz_loadu_epi64(mask, source + w);
+            _mm512_mask_storeu_epi64(target + w, mask, _mm512_or_si512(a, b));
+        }
+    }
+
+    __attribute__((target("avx512f"))) void andAVX512(std::uint64_t *target, const std::uint64_t *source,
+                                                       std::size_t words) {
+        std::size_t w = 0;
+        for (; w + 8 <= words; w += 8) {
+            __m512i a = _mm512_loadu_si512(target + w);
+            __m512i b = _mm512_loadu_si512(source + w);
+            _mm512_storeu_si512(target + w, _mm512_and_si512(a, b));
+        }
+        if (w < words) {
+            const __mmask8 mask = static_cast<__mmask8>((1u << (words - w)) - 1);
+            __m512i a = _mm512_maskz_loadu_epi64(mask, target + w);
+            __m512i b = _mm512_maskz_loadu_epi64(mask, source + w);
+            _mm512_mask_storeu_epi64(target + w, mask, _mm512_and_si512(a, b));
+        }
+    }
+
+    __attribute__((target("avx512f,avx512vpopcntdq"))) std::size_t countAVX512(const std::uint64_t *words,
+                                                                               std::size_t length) {
+        __m512i sums = _mm512_setzero_si512();
+        std::size_t w = 0;
+        for (; w + 8 <= length; w += 8) {
+            sums = _mm512_add_epi64(sums, _mm512_popcnt_epi64(_mm512_loadu_si512(words + w)));
+        }
+        if (w < length) {
+            const __mmask8 mask = static_cast<__mmask8>((1u << (length - w)) - 1);
+            sums = _mm512_add_epi64(sums, _mm512_popcnt_epi64(_mm512_maskz_loadu_epi64(mask, words + w)));
+        }
+        alignas(64) std::uint64_t lanes[8];
+        _mm512_store_si512(lanes, sums);
+        std::size_t total = 0;
+        for (std::uint64_t lane : lanes) total += lane;
+        return total;
+    }
+
+    __attribute__((target("avx512f"))) bool anyAVX512(const std::uint64_t *words, std::size_t length) {
+        std::size_t w = 0;
+        for (; w + 8 <= length; w += 8) {
+            __m512i v = _mm512_loadu_si512(words + w);
+            if (_mm512_test_epi64_mask(v, v)) return true;
+        }
+        if (w < length) {
+            const __mmask8 mask = static_cast<__mmask8>((1u << (length - w)) - 1);
+            __m512i v = _mm512_maskz_loadu_epi64(mask, words + w);
+            if (_mm512_test_epi64_mask(v, v)) return true;
+        }
+        return false;
+    }
+
+    const BitKernels avx2Kernels{"avx2", orAVX2, andAVX2, countAVX2, anyAVX2};
+
+    // Popcount in AVX-512 vraagt VPOPCNTDQ; zonder die uitbreiding blijft count op AVX2
+    const BitKernels avx512Kernels{"avx512", orAVX512, andAVX512, countAVX512, anyAVX512};
+    const BitKernels avx512NoPopcntKernels{"avx512", orAVX512, andAVX512, countAVX2, anyAVX512};
+#endif
+
+    const BitKernels &select() {
+        if (const BitKernels *kernels = bitKernels("avx512")) return *kernels;
+        if (const BitKernels *kernels = bitKernels("avx2")) return *kernels;
+        return scalarKernels;
+    }
+}
+
+const BitKernels &bitKernels() {
+    static const BitKernels &best = select();
+    return best;
+}
+
+const BitKernels *bitKernels(std::string_view name) {
+    if (name == "scalar") return &scalarKernels;
+#ifdef BITKERNELS_X86
+    __builtin_cpu_init();
+    const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+    if (name == "avx2") return avx2 ? &avx2Kernels : nullptr;
+    if (name == "avx512") {
+        if (!avx2 || !__builtin_cpu_supports("avx512f")) return nullptr;
+        return __builtin_cpu_supports("avx512vpopcntdq") ? &avx512Kernels : &avx512NoPopcntKernels;
+    }
+#endif
+    return nullptr;
+}
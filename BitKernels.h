@@ -0,0 +1,24 @@
+#ifndef BITKERNELS_H
+#define BITKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// Kernels op rijen van 64-bit woorden (dynamische lengte). Bij het eerste gebruik wordt de
+// snelste variant gekozen die de CPU ondersteunt (AVX-512, AVX2, anders scalair); op andere
+// architecturen is er enkel de scalaire variant.
+struct BitKernels {
+    const char *name;
+    void (*orInto)(std::uint64_t *target, const std::uint64_t *source, std::size_t words);
+    void (*andInto)(std::uint64_t *target, const std::uint64_t *source, std::size_t words);
+    std::size_t (*count)(const std::uint64_t *words, std::size_t length);
+    bool (*any)(const std::uint64_t *words, std::size_t length);
+};
+
+const BitKernels &bitKernels();
+
+// Een specifieke variant ("scalar", "avx2", "avx512"), of nullptr als de CPU ze niet kent
+const BitKernels *bitKernels(std::string_view name);
+
+#endif // BITKERNELS_H
@@ -0,0 +1,103 @@
+// Differentiële test van de bitkernels: elke variant die deze CPU kent ("avx2", "avx512") en
+// de vaste breedtes van BitWords tegenover de scalaire variant, op willekeurige rijen van
+// 1..40 woorden (dus met staarten achter elk blok van 4 of 8) op verschoven adressen. Woorden
+// net voor en na de rij mogen niet veranderen. Varianten die de CPU niet kent, worden gemeld
+// en overgeslagen; op CI zonder AVX-512 test dit dus enkel AVX2 en de vaste breedtes.
+//
+//   ./PDA2CFG_bitkernels_test [seed]
+#include "Bitset.h"
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void fail(const std::string &message) {
+        std::cerr << "FAIL: " << message << std::endl;
+        ++failures;
+    }
+
+    using Row = std::vector<std::uint64_t>;
+
+    // Rij met een woord marge aan beide kanten; dichte, ijle of lege inhoud
+    Row randomRow(std::mt19937_64 &random, std::size_t words) {
+        Row row(words + 2, 0x5a5a5a5a5a5a5a5aULL);
+        const unsigned density = random() % 3;
+        for (std::size_t w = 1; w <= words; ++w) {
+            if (density == 0) row[w] = random();
+            else if (density == 1) row[w] = random() % 8 == 0 ? std::uint64_t(1) << (random() % 64) : 0;
+            else row[w] = 0;
+        }
+        return row;
+    }
+
+    // Zelfde interface als BitKernels, voor BitWords met een vaste breedte
+    template <std::size_t Words>
+    BitKernels fixedWidth() {
+        return {"fixed", BitWords<Words>::orInto, BitWords<Words>::andInto, BitWords<Words>::count,
+                BitWords<Words>::any};
+    }
+
+    void compare(const BitKernels &kernels, const std::string &label, std::size_t words, std::mt19937_64 &random) {
+        const BitKernels &scalar = *bitKernels("scalar");
+        const Row source = randomRow(random, words);
+        const Row target = randomRow(random, words);
+        const std::string where = label + " at " + std::to_string(words) + " words";
+
+        Row expected = target, actual = target;
+        scalar.orInto(expected.data() + 1, source.data() + 1, words);
+        kernels.orInto(actual.data() + 1, source.data() + 1, words);
+        if (actual != expected) fail(where + ": orInto differs");
+
+        expected = target;
+        actual = target;
+        scalar.andInto(expected.data() + 1, source.data() + 1, words);
+        kernels.andInto(actual.data() + 1, source.data() + 1, words);
+        if (actual != expected) fail(where + ": andInto differs");
+
+        if (kernels.count(source.data() + 1, words) != scalar.count(source.data() + 1, words)) {
+            fail(where + ": count differs");
+        }
+        if (kernels.any(source.data() + 1, words) != scalar.any(source.data() + 1, words)) {
+            fail(where + ": any differs");
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    std::mt19937_64 random(argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 1);
+
+    std::vector<const BitKernels *> variants;
+    for (const char *name : {"avx2", "avx512"}) {
+        if (const BitKernels *kernels = bitKernels(name)) {
+            variants.push_back(kernels);
+        } else {
+            std::cout << "skipping " << name << ": not supported by this CPU" << std::endl;
+        }
+    }
+    variants.push_back(&bitKernels());  // de gekozen variant, zoals BitWords<0> en Bitset ze gebruiken
+
+    const BitKernels fixed1 = fixedWidth<1>(), fixed2 = fixedWidth<2>(), fixed4 = fixedWidth<4>(),
+                     fixed8 = fixedWidth<8>();
+    for (int round = 0; round < 200; ++round) {
+        for (const BitKernels *kernels : variants) {
+            for (std::size_t words = 1; words <= 40; ++words) {
+                compare(*kernels, kernels->name, words, random);
+            }
+        }
+        compare(fixed1, "BitWords<1>", 1, random);
+        compare(fixed2, "BitWords<2>", 2, random);
+        compare(fixed4, "BitWords<4>", 4, random);
+        compare(fixed8, "BitWords<8>", 8, random);
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "bit kernels match the scalar fallback (" << bitKernels().name << " selected)" << std::endl;
+    return 0;
+}
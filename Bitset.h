@@ -0,0 +1,95 @@
+#ifndef BITSET_H
+#define BITSET_H
+
+#include "BitKernels.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Bewerkingen op een rij van Words 64-bit woorden. Vaste breedtes (1, 2, 4, 8 woorden = 64..512
+// bits) zijn volledig inline zodat de compiler de lus ontrolt; Words == 0 is de dynamische
+// breedte en gaat via de SIMD-kernels van BitKernels.
+template <std::size_t Words>
+struct BitWords {
+    static void orInto(std::uint64_t *target, const std::uint64_t *source, std::size_t = Words) {
+        for (std::size_t w = 0; w < Words; ++w) target[w] |= source[w];
+    }
+    static void andInto(std::uint64_t *target, const std::uint64_t *source, std::size_t = Words) {
+        for (std::size_t w = 0; w < Words; ++w) target[w] &= source[w];
+    }
+    static std::size_t count(const std::uint64_t *words, std::size_t = Words) {
+        std::size_t total = 0;
+        for (std::size_t w = 0; w < Words; ++w) total += __builtin_popcountll(words[w]);
+        return total;
+    }
+    static bool any(const std::uint64_t *words, std::size_t = Words) {
+        std::uint64_t merged = 0;
+        for (std::size_t w = 0; w < Words; ++w) merged |= words[w];
+        return merged != 0;
+    }
+};
+
+template <>
+struct BitWords<0> {
+    static void orInto(std::uint64_t *target, const std::uint64_t *source, std::size_t words) {
+        bitKernels().orInto(target, source, words);
+    }
+    static void andInto(std::uint64_t *target, const std::uint64_t *source, std::size_t words) {
+        bitKernels().andInto(target, source, words);
+    }
+    static std::size_t count(const std::uint64_t *words, std::size_t length) {
+        return bitKernels().count(words, length);
+    }
+    static bool any(const std::uint64_t *words, std::size_t length) { return bitKernels().any(words, length); }
+};
+
+// Dynamische bitset op 64-bit woorden, geindexeerd op symbool-id.
+class Bitset {
+public:
+    Bitset() = default;
+    explicit Bitset(std::size_t bits) : words((bits + 63) / 64, 0), bits(bits) {}
+
+    std::size_t size() const { return bits; }
+
+    bool test(std::size_t i) const { return words[i >> 6] >> (i & 63) & 1; }
+    void set(std::size_t i) { words[i >> 6] |= std::uint64_t(1) << (i & 63); }
+    void reset(std::size_t i) { words[i >> 6] &= ~(std::uint64_t(1) << (i & 63)); }
+
+    // Zet bit i en geeft terug of het daarvoor nog niet gezet was
+    bool testAndSet(std::size_t i) {
+        std::uint64_t mask = std::uint64_t(1) << (i & 63);
+        std::uint64_t &word = words[i >> 6];
+        bool wasClear = !(word & mask);
+        word |= mask;
+        return wasClear;
+    }
+
+    Bitset &operator|=(const Bitset &other) {
+        BitWords<0>::orInto(words.data(), other.words.data(), words.size());
+        return *this;
+    }
+
+    Bitset &operator&=(const Bitset &other) {
+        BitWords<0>::andInto(words.data(), other.words.data(), words.size());
+        return *this;
+    }
+
+    std::size_t count() const { return BitWords<0>::count(words.data(), words.size()); }
+    bool any() const { return BitWords<0>::any(words.data(), words.size()); }
+
+    // Roept f(i) op voor elke gezette bit, in stijgende volgorde
+    template <typename F>
+    void forEach(F f) const {
+        for (std::size_t w = 0; w < words.size(); ++w) {
+            for (std::uint64_t word = words[w]; word; word &= word - 1) {
+                f(w * 64 + __builtin_ctzll(word));
+            }
+        }
+    }
+
+private:
+    std::vector<std::uint64_t> words;
+    std::size_t bits = 0;
+};
+
+#endif // BITSET_H
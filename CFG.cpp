@@ -3,28 +3,51 @@
 //
 
 #include "CFG.h"
-#include <regex>
-#include <queue>
+#include "GrammarAnalysis.h"
+#include "GrammarBinary.h"
+#include "JsonWriter.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <stdexcept>
+#include <unordered_set>
+#include <sys/resource.h>
 
 CFG::CFG(string Filename) {
-    ifstream input(Filename);
+    ifstream input(Filename, ios::binary);
     if (!input) {
         cerr << "Unable to open file " << Filename << endl;
         exit(1);
     }
+    if (isGrammarBinary(input)) {
+        // Binair bestand (bv. van --save-cnf): mappen in plaats van json te parsen
+        input.close();
+        *this = CFG(MappedGrammar(Filename));
+        return;
+    }
+    load(input);
+}
+
+CFG::CFG(istream &input) {
+    load(input);
+}
+
+void CFG::load(istream &input) {
     json j;
     input >> j;
 
     // nonterminals
-    nonTerminals = j["Variables"].get<set<string>>();
+    for (const auto& variable : j["Variables"]) {
+        addVariable(variable.get<string>());
+    }
 
     // terminals
     for (const auto& terminal : j["Terminals"]) {
         terminals.insert(terminal.get<string>()[0]);
     }
 
-    // productionRules
-    for (const auto& production : j["Productions"]) {
+    // productions
+    auto addJSONProduction = [this](const json& production) {
         string head = production["head"];
         string body = "";
 
@@ -35,339 +58,621 @@ CFG::CFG(string Filename) {
             }
         }
 
-        // Add the production rule to the map
-        productionRules[head].push_back(body);
+        addProduction(head, body);
+    };
+    if (j.contains("Productions")) {
+        for (const auto& production : j["Productions"]) addJSONProduction(production);
+    } else {
+        // JSONL (writeJSONLines): na de kopregel een productie per regel
+        json production;
+        while (input >> ws, input.peek() != EOF) {
+            input >> production;
+            addJSONProduction(production);
+        }
     }
 
     // startSymbol
     startSymbol = j["Start"].get<string>();
 
+    // Enkel aanwezig als het lege woord zonder ε-regel in de taal zit, zie Grammar::acceptsEmpty
+    acceptsEmpty = j.value("AcceptsEmpty", false);
 }
 
-void CFG::print() {
-    // Print non-terminals
-    cout << "V = {";
-    for (auto it = nonTerminals.begin(); it != nonTerminals.end(); ++it) {
-        cout << *it;
-        if (next(it) != nonTerminals.end()) cout << ", ";
+namespace {
+    // Roept f(symbool) op voor elk symbool van een body ("A b C")
+    template <typename F>
+    void forEachSymbol(string_view body, F f) {
+        size_t pos = 0;
+        while (pos < body.size()) {
+            size_t end = body.find(' ', pos);
+            if (end == string_view::npos) end = body.size();
+            if (end > pos) f(body.substr(pos, end - pos));
+            pos = end + 1;
+        }
     }
-    cout << "}" << endl;
 
-    // Print terminals
-    cout << "T = {";
-    for (auto it = terminals.begin(); it != terminals.end(); ++it) {
-        cout << *it;
-        if (next(it) != terminals.end()) cout << ", ";
+    // Vergelijkt twee productieregels "    head   -> `body`\n" byte per byte, zonder ze op te bouwen
+    using Line = array<string_view, 4>;
+
+    Line productionLine(string_view head, string_view body) {
+        return {head, "   -> `", body.empty() ? string_view(" ") : string_view(body), "`\n"};
     }
-    cout << "}" << endl;
 
-    // Verzamel en sorteer productie regels
-    cout << "P = {" << endl;
-    vector<string> productionStrings;
-    for (const auto& rule : productionRules) {
-        // Sorteer lege producties eerst
-        vector<string> epsilonProductions;
-        vector<string> otherProductions;
-
-        for (const auto& prod : rule.second) {
-            if (prod.empty()) {
-                epsilonProductions.push_back("    " + rule.first + "   -> ` `\n");
-            } else {
-                otherProductions.push_back("    " + rule.first + "   -> `" + prod + "`\n");
-            }
+    bool lineLess(const Line& a, const Line& b) {
+        size_t pa = 0, pb = 0, ia = 0, ib = 0;
+        while (pa < a.size() && pb < b.size()) {
+            if (ia == a[pa].size()) { ++pa; ia = 0; continue; }
+            if (ib == b[pb].size()) { ++pb; ib = 0; continue; }
+            unsigned char ca = a[pa][ia++], cb = b[pb][ib++];
+            if (ca != cb) return ca < cb;
         }
+        while (pb < b.size() && ib == b[pb].size()) { ++pb; ib = 0; }
+        return pb < b.size();
+    }
+}
 
-        // Voeg de gesorteerde producties toe aan de uitvoer
-        productionStrings.insert(productionStrings.end(), epsilonProductions.begin(), epsilonProductions.end());
-        productionStrings.insert(productionStrings.end(), otherProductions.begin(), otherProductions.end());
+CFG::CFG(Grammar grammar) : store(move(grammar)) {
+    for (Grammar::Id id = 0; id < store.symbolCount(); ++id) {
+        if (!store.isVariable(id) && store.name(id).size() == 1) terminals.insert(store.name(id)[0]);
+        declared.push_back(store.isVariable(id) ? 1 : 0);
     }
+    if (store.startSymbol != SymbolTable::npos) startSymbol = store.name(store.startSymbol);
+    acceptsEmpty = store.acceptsEmpty;
+}
 
-    // Sorteer de productie strings op ASCII-volgorde (behalve de nieuwe volgorde binnen elke kop)
-    sort(productionStrings.begin(), productionStrings.end());
+CFG::CFG(const MappedGrammar &grammar) : CFG(grammar.toGrammar()) {
+}
 
-    // Print de gesorteerde productie strings
-    for (const auto& prodStr : productionStrings) {
-        cout << prodStr;
+vector<string_view> CFG::nonTerminals() const {
+    vector<string_view> names;
+    for (Grammar::Id id = 0; id < declared.size(); ++id) {
+        if (declared[id]) names.push_back(store.name(id));
     }
-    cout << "}" << endl;
+    sort(names.begin(), names.end());
+    return names;
+}
 
-    // Print start symbol
-    cout << "S = " << startSymbol << endl;
+void CFG::addVariable(string_view name) {
+    Grammar::Id id = store.addVariable(name);
+    if (id >= declared.size()) declared.resize(id + 1, 0);
+    declared[id] = 1;
 }
 
+void CFG::addProduction(string_view head, string_view body) {
+    vector<Grammar::Id> symbols;
+    forEachSymbol(body, [&](string_view token) {
+        Grammar::Id id = store.symbols.find(token);
+        symbols.push_back(id != SymbolTable::npos ? id : store.addTerminal(token));
+    });
+    store.addProduction(store.addVariable(head), symbols);
+}
 
+vector<uint32_t> CFG::productionsByHead() const {
+    // Heads op naam sorteren, dan de producties per head tellen en verdelen: stabiel per head
+    vector<uint32_t> first(store.symbolCount(), 0);
+    vector<Grammar::Id> heads;
+    for (size_t p = 0; p < store.productionCount(); ++p) {
+        if (first[store.head(p)]++ == 0) heads.push_back(store.head(p));
+    }
+    sort(heads.begin(), heads.end(), [this](Grammar::Id a, Grammar::Id b) { return store.name(a) < store.name(b); });
+    uint32_t at = 0;
+    for (Grammar::Id head : heads) {
+        const uint32_t count = first[head];
+        first[head] = at;
+        at += count;
+    }
+    vector<uint32_t> order(store.productionCount());
+    for (size_t p = 0; p < store.productionCount(); ++p) {
+        order[first[store.head(p)]++] = static_cast<uint32_t>(p);
+    }
+    return order;
+}
 
+Grammar CFG::toGrammar() const {
+    Grammar grammar;
+    for (string_view nt : nonTerminals()) {
+        grammar.addVariable(nt);
+    }
+    for (char terminal : terminals) {
+        grammar.addTerminal(string(1, terminal));
+    }
+    grammar.startSymbol = grammar.addVariable(startSymbol);
+    grammar.acceptsEmpty = acceptsEmpty;
+
+    // Symbolen die nergens gedeclareerd zijn gedragen zich als terminals
+    vector<Grammar::Id> ids(store.symbolCount(), SymbolTable::npos);  // store-id -> id hier, voor bodies
+    vector<Grammar::Id> body;
+    for (uint32_t p : productionsByHead()) {
+        Grammar::Id head = grammar.addVariable(store.name(store.head(p)));
+        body.clear();
+        for (Grammar::Id symbol : store.body(p)) {
+            if (ids[symbol] == SymbolTable::npos) {
+                string_view token = store.name(symbol);
+                Grammar::Id id = grammar.symbols.find(token);
+                ids[symbol] = id != SymbolTable::npos ? id : grammar.addTerminal(token);
+            }
+            body.push_back(ids[symbol]);
+        }
+        grammar.addProduction(head, body);
+    }
+    return grammar;
+}
 
+void CFG::write(OutputSink &out, const string &format) const {
+    if (format == "json") {
+        writeJSON(out);
+    } else if (format == "jsonl") {
+        writeJSONLines(out);
+    } else if (format == "binary") {
+        writeBinary(out);
+    } else {
+        print(out);
+    }
+}
 
+Fingerprint CFG::fingerprint() const {
+    vector<Fingerprint> variables, symbols, productions;
+    for (string_view nt : nonTerminals()) variables.push_back(FingerprintBuilder().add(nt).finish());
+    for (char terminal : terminals) symbols.push_back(FingerprintBuilder().add(string_view(&terminal, 1)).finish());
+    for (size_t p = 0; p < store.productionCount(); ++p) {
+        FingerprintBuilder production;
+        production.add(store.name(store.head(p)));
+        for (Grammar::Id symbol : store.body(p)) production.add(store.name(symbol));
+        productions.push_back(production.finish());
+    }
+
+    FingerprintBuilder builder;
+    builder.add("cfg").add(startSymbol);
+    if (acceptsEmpty) builder.add("accepts-empty");  // enkel dan: bestaande sleutels blijven gelijk
+    builder.addUnordered(move(variables)).addUnordered(move(symbols)).addUnordered(move(productions));
+    return builder.finish();
+}
 
+void CFG::print() const {
+    OutputSink out(stdout);
+    print(out);
+}
 
-void CFG::eliminateEpsilonProductions() {
-    set<string> nullable;
+void CFG::print(OutputSink& out) const {
+    // Print non-terminals
+    const vector<string_view> variables = nonTerminals();
+    out << "V = {";
+    for (auto it = variables.begin(); it != variables.end(); ++it) {
+        out << *it;
+        if (next(it) != variables.end()) out << ", ";
+    }
+    out << "}\n";
 
-    // Stap 1: Bepaal nullable variabelen
-    for (const auto& rule : productionRules) {
-        for (const auto& body : rule.second) {
-            if (body.empty()) {
-                nullable.insert(rule.first);
-            }
-        }
+    // Print terminals
+    out << "T = {";
+    for (auto it = terminals.begin(); it != terminals.end(); ++it) {
+        out << *it;
+        if (next(it) != terminals.end()) out << ", ";
     }
+    out << "}\n";
 
-    bool changed;
-    do {
-        changed = false;
-        for (const auto& rule : productionRules) {
-            for (const auto& body : rule.second) {
-                bool allNullable = true;
-                for (char symbol : body) {
-                    if (!nullable.count(string(1, symbol))) {
-                        allNullable = false;
-                        break;
-                    }
-                }
-                if (allNullable && nullable.insert(rule.first).second) {
-                    changed = true;
-                }
-            }
+    // Regels in de ASCII-volgorde van de volledige regels, rechtstreeks naar de uitvoer
+    out << "P = {\n";
+    auto writeLine = [&out](string_view head, string_view body) {
+        out << "    ";
+        for (string_view piece : productionLine(head, body)) {
+            out << piece;
         }
-    } while (changed);
+    };
+    // Wachtende regels: head en (begin, lengte) van de body in texts, zonder een string per regel
+    string texts;
+    vector<pair<string_view, pair<size_t, size_t>>> productions;
+    auto line = [&texts](const auto& x) {
+        return productionLine(x.first, string_view(texts).substr(x.second.first, x.second.second));
+    };
+    auto less = [&line](const auto& x, const auto& y) { return lineLess(line(x), line(y)); };
+
+    // Na een head volgt "   -> `"; zolang geen head een byte <= ' ' bevat, ordenen de regels van
+    // verschillende heads zich dus zoals hun namen. Dan volstaat het de bodies per head te ordenen
+    // (enkel die van een head staan tegelijk als tekst klaar), en staan die al goed (zoals na
+    // inlezen van gesorteerde invoer), dan wordt er niet gesorteerd.
+    bool mapOrder = true;
+    for (size_t p = 0; p < store.productionCount() && mapOrder; ++p) {
+        string_view head = store.name(store.head(p));
+        mapOrder = none_of(head.begin(), head.end(), [](unsigned char c) { return c <= ' '; });
+    }
+    auto flush = [&] {
+        if (!is_sorted(productions.begin(), productions.end(), less)) {
+            sort(productions.begin(), productions.end(), less);
+        }
+        for (const auto& production : productions) {
+            writeLine(production.first, string_view(texts).substr(production.second.first, production.second.second));
+        }
+        productions.clear();
+        texts.clear();
+    };
+    forEachProduction([&](string_view head, string_view body) {
+        if (mapOrder && !productions.empty() && productions.back().first != head) flush();
+        productions.push_back({head, {texts.size(), body.size()}});
+        texts += body;
+    });
+    flush();
+    out << "}\n";
 
-    // Log de nullables
-    cout << "  Nullables are {";
-    for (auto it = nullable.begin(); it != nullable.end(); ++it) {
-        cout << *it;
-        if (next(it) != nullable.end()) cout << ", ";
+    // Print start symbol
+    out << "S = " << startSymbol << '\n';
+    if (acceptsEmpty) out << "AcceptsEmpty = true\n";
+    out.flush();
+}
+
+void CFG::writeJSON(OutputSink& out) const {
+    // Zelfde schema als CFG(string Filename) inleest
+    const vector<string_view> variables = nonTerminals();
+    out << "{\n  \"Variables\": [";
+    for (auto it = variables.begin(); it != variables.end(); ++it) {
+        if (it != variables.begin()) out << ", ";
+        writeJsonString(out, *it);
     }
-    cout << "}\n";
+    out << "],\n  \"Terminals\": [";
+    for (auto it = terminals.begin(); it != terminals.end(); ++it) {
+        if (it != terminals.begin()) out << ", ";
+        writeJsonString(out, string_view(&*it, 1));
+    }
+    out << "],\n  \"Productions\": [";
+    bool first = true;
+    forEachProduction([&](string_view head, string_view body) {
+        out << (first ? "\n    " : ",\n    ");
+        first = false;
+        writeProductionJSON(out, head, body);
+    });
+    out << (first ? "],\n  \"Start\": " : "\n  ],\n  \"Start\": ");
+    writeJsonString(out, startSymbol);
+    if (acceptsEmpty) out << ",\n  \"AcceptsEmpty\": true";
+    out << "\n}\n";
+    out.flush();
+}
 
-    // Stap 2: Creëer nieuwe producties door nullable variabelen te verwijderen
-    map<string, vector<string>> newProductions;
-    for (const auto& rule : productionRules) {
-        for (const auto& body : rule.second) {
-            vector<string> bodies = {body};
+void CFG::writeJSONLines(OutputSink& out) const {
+    // Eerste regel: alles behalve de producties; daarna een productie per regel
+    const vector<string_view> variables = nonTerminals();
+    out << "{\"Variables\": [";
+    for (auto it = variables.begin(); it != variables.end(); ++it) {
+        if (it != variables.begin()) out << ", ";
+        writeJsonString(out, *it);
+    }
+    out << "], \"Terminals\": [";
+    for (auto it = terminals.begin(); it != terminals.end(); ++it) {
+        if (it != terminals.begin()) out << ", ";
+        writeJsonString(out, string_view(&*it, 1));
+    }
+    out << "], \"Start\": ";
+    writeJsonString(out, startSymbol);
+    if (acceptsEmpty) out << ", \"AcceptsEmpty\": true";
+    out << "}\n";
+    forEachProduction([&](string_view head, string_view body) {
+        writeProductionJSON(out, head, body);
+        out << '\n';
+    });
+    out.flush();
+}
 
-            // Verwijder nullable variabelen
-            for (size_t i = 0; i < body.size(); ++i) {
-                if (nullable.count(string(1, body[i]))) {
-                    size_t currentSize = bodies.size();
-                    for (size_t j = 0; j < currentSize; ++j) {
-                        string newBody = bodies[j];
-                        newBody.erase(remove(newBody.begin(), newBody.end(), body[i]), newBody.end());
-
-                        // Voeg alleen unieke en niet-lege producties toe, zonder dubbele spaties
-                        newBody.erase(unique(newBody.begin(), newBody.end(), [](char a, char b) { return a == ' ' && b == ' '; }), newBody.end());
-                        if (!newBody.empty() && find(bodies.begin(), bodies.end(), newBody) == bodies.end()) {
-                            bodies.push_back(newBody);
-                        }
-                    }
-                }
-            }
+void CFG::writeBinary(OutputSink& out) const {
+    writeGrammarBinary(toGrammar(), out);
+}
+
+void CFG::writeProductionJSON(OutputSink& out, string_view head, string_view body) {
+    out << "{\"head\": ";
+    writeJsonString(out, head);
+    out << ", \"body\": [";
+    bool first = true;
+    forEachSymbol(body, [&](string_view symbol) {
+        if (!first) out << ", ";
+        first = false;
+        writeJsonString(out, symbol);
+    });
+    out << "]}";
+}
+
+set<string> CFG::computeNullable() const {
+    Grammar grammar = toGrammar();
+    vector<char> nullable = ::computeNullable(grammar);
+
+    set<string> result;
+    for (Grammar::Id id = 0; id < grammar.symbolCount(); ++id) {
+        if (nullable[id]) result.emplace(grammar.symbols.name(id));
+    }
+    return result;
+}
 
-            // Verwijder extra spaties en voeg producties toe
-            for (auto& newBody : bodies) {
-                newBody = regex_replace(newBody, regex("^ +| +$|( ) +"), "$1");  // Verwijder begin/eindspaties en dubbele spaties
-                if (!newBody.empty()) newProductions[rule.first].push_back(newBody);
+namespace {
+    // Zelfde volgorde als de bodies als tekst ("A b C") vergelijken, naam per naam
+    bool bodyTextLess(const Grammar& grammar, Grammar::Body a, Grammar::Body b) {
+        const size_t common = min(a.size(), b.size());
+        for (size_t i = 0; i < common; ++i) {
+            if (a[i] == b[i]) continue;
+            string_view x = grammar.name(a[i]), y = grammar.name(b[i]);
+            const size_t m = min(x.size(), y.size());
+            if (int c = x.substr(0, m).compare(y.substr(0, m))) return c < 0;
+            // De ene naam is een prefix van de andere: na de kortste volgt een spatie of het einde
+            auto after = [](Grammar::Body body, size_t i) { return i + 1 < body.size() ? int(' ') : -1; };
+            if (x.size() < y.size()) return after(a, i) < static_cast<unsigned char>(y[m]);
+            return static_cast<unsigned char>(x[m]) < after(b, i);
+        }
+        return a.size() < b.size();
+    }
+
+    // Rang van elk symbool in de naamvolgorde. Bevat geen naam een teken <= ' ', dan is de
+    // tekstvolgorde van bodies gelijk aan de lexicografische volgorde van hun rangen (een spatie
+    // of het einde na een naam sorteert voor elk ander teken). Anders leeg.
+    vector<uint32_t> nameRanks(const Grammar& grammar) {
+        vector<Grammar::Id> order(grammar.symbolCount());
+        for (Grammar::Id id = 0; id < order.size(); ++id) {
+            for (char c : grammar.name(id)) {
+                if (static_cast<unsigned char>(c) <= ' ') return {};
             }
+            order[id] = id;
         }
+        sort(order.begin(), order.end(), [&](Grammar::Id a, Grammar::Id b) { return grammar.name(a) < grammar.name(b); });
+        vector<uint32_t> rank(order.size());
+        for (uint32_t r = 0; r < order.size(); ++r) rank[order[r]] = r;
+        return rank;
     }
 
-    // Stap 3: Verwijder lege producties en sorteer producties voor ASCII-volgorde
-    for (auto& rule : newProductions) {
-        auto& bodies = rule.second;
-        bodies.erase(remove(bodies.begin(), bodies.end(), ""), bodies.end());
+    bool sameBody(Grammar::Body a, Grammar::Body b) {
+        return a.size() == b.size() && equal(a.begin(), a.end(), b.begin());
     }
+}
+
+void CFG::canonicalize() {
+    // Heads liggen al op naam vast; enkel de volgorde van de bodies per head hangt van de invoer af
+    vector<uint32_t> order = productionsByHead();
+    for (size_t begin = 0, end = 0; begin < order.size(); begin = end) {
+        const Grammar::Id head = store.head(order[begin]);
+        while (end < order.size() && store.head(order[end]) == head) ++end;
+        stable_sort(order.begin() + begin, order.begin() + end, [this](uint32_t a, uint32_t b) {
+            return bodyTextLess(store, store.body(a), store.body(b));
+        });
+    }
+    ProductionBuffer sorted;
+    for (uint32_t p : order) sorted.add(store.head(p), store.body(p).begin(), store.body(p).size());
+    store.replaceProductions(move(sorted));
+}
+
+CFG::Work CFG::startWork() const {
+    Work work{toGrammar(), {}};
+    // toGrammar geeft de gedeclareerde variabelen de eerste ids
+    work.declared.assign(work.grammar.symbolCount(), 0);
+    fill(work.declared.begin(), work.declared.begin() + count(declared.begin(), declared.end(), 1), 1);
+    return work;
+}
 
-    // Stap 4: Log productietellingen
-    size_t originalProdCount = 0;
-    for (const auto& rule : productionRules) {
-        originalProdCount += rule.second.size();
+// Symbolen die toGrammar() van de huidige stand zou bevatten; namen van andere (verwijderde)
+// symbolen mogen opnieuw gebruikt worden
+vector<char> CFG::liveSymbols(const Work& work) const {
+    const Grammar& grammar = work.grammar;
+    vector<char> live(work.declared);
+    live.resize(grammar.symbolCount(), 0);
+    for (char terminal : terminals) {
+        Grammar::Id id = grammar.symbols.find(string_view(&terminal, 1));
+        if (id != SymbolTable::npos) live[id] = 1;
     }
-    size_t newProdCount = 0;
-    for (const auto& rule : newProductions) {
-        newProdCount += rule.second.size();
+    if (grammar.startSymbol != SymbolTable::npos) live[grammar.startSymbol] = 1;
+    for (size_t p = 0; p < grammar.productionCount(); ++p) {
+        live[grammar.head(p)] = 1;
+        for (Grammar::Id symbol : grammar.body(p)) live[symbol] = 1;
     }
-    cout << "  Created " << newProdCount << " productions, original had " << originalProdCount << "\n\n";
-
-    // Update de productie regels
-    productionRules = newProductions;
+    return live;
 }
 
+Grammar::Id CFG::addVariable(Work& work, string_view name) {
+    Grammar::Id id = work.grammar.addVariable(name);
+    if (id >= work.declared.size()) work.declared.resize(id + 1, 0);
+    work.declared[id] = 1;
+    return id;
+}
 
+// Neemt de werkvorm over als opslag; enkel op het einde en voor trace-uitvoer
+void CFG::finishWork(Work work) {
+    store = move(work.grammar);
+    declared = move(work.declared);
+    acceptsEmpty = store.acceptsEmpty;
+}
 
+void CFG::eliminateEpsilonProductions(Work& work) {
+    // Stap 1: Bepaal nullable variabelen (worklist met tellers per productie)
+    const Grammar& grammar = work.grammar;
+    vector<char> nullable = ::computeNullable(grammar);
 
-void CFG::eliminateUnitProductions() {
-    std::set<std::pair<std::string, std::string>> unitPairs;
-    std::set<std::pair<std::string, std::string>> directUnitPairs;
-    for (const auto& nt : nonTerminals) {
-        unitPairs.insert({nt, nt});
-    }
-    for (const auto& rule : productionRules) {
-        for (const auto& prod : rule.second) {
-            if (nonTerminals.count(prod)) {
-                unitPairs.insert({rule.first, prod});
-                directUnitPairs.insert({rule.first, prod});
-            }
+    // Log de nullables
+    if (verbosity == Verbosity::Trace) {
+        set<string> nullableNames;
+        for (Grammar::Id id = 0; id < grammar.symbolCount(); ++id) {
+            if (nullable[id]) nullableNames.emplace(grammar.symbols.name(id));
+        }
+        cout << "  Nullables are {";
+        for (auto it = nullableNames.begin(); it != nullableNames.end(); ++it) {
+            cout << *it;
+            if (next(it) != nullableNames.end()) cout << ", ";
         }
+        cout << "}\n";
     }
 
-    bool changed;
-    do {
-        changed = false;
-        for (const auto& [A, B] : unitPairs) {
-            for (const auto& [C, D] : unitPairs) {
-                if (B == C && unitPairs.insert({A, D}).second) {
-                    changed = true;
+    // Stap 2: Creëer nieuwe producties door elke deelverzameling van nullable voorkomens weg te laten
+    ProductionBuffer result;
+    auto resultBody = [&](uint32_t p) {
+        return Grammar::Body{result.bodySymbols.data() + result.offsets[p], result.bodySymbols.data() + result.offsets[p + 1]};
+    };
+    // Varianten van dezelfde productie die al in result staan, op hash van de body
+    auto hashBody = [&](uint32_t p) {
+        size_t hash = 0;
+        for (Grammar::Id symbol : resultBody(p)) hash = (hash ^ symbol) * 0x100000001b3ULL;
+        return hash;
+    };
+    auto equalBody = [&](uint32_t a, uint32_t b) { return sameBody(resultBody(a), resultBody(b)); };
+    unordered_set<uint32_t, decltype(hashBody), decltype(equalBody)> seen(16, hashBody, equalBody);
+
+    vector<size_t> nullablePositions;
+    vector<Grammar::Id> newBody;
+    for (size_t p = 0; p < grammar.productionCount(); ++p) {
+        Grammar::Body body = grammar.body(p);
+        nullablePositions.clear();
+        for (size_t i = 0; i < body.size(); ++i) {
+            if (nullable[body[i]]) nullablePositions.push_back(i);
+        }
+
+        // Ook 1 << 64 zelf zou al ongedefinieerd zijn; ver daarvoor is het geheugen op
+        if (nullablePositions.size() >= 64 || uint64_t(1) << nullablePositions.size() > productionLimit) {
+            throw length_error("epsilon elimination: a production of " + string(grammar.name(grammar.head(p))) +
+                               " has " + to_string(nullablePositions.size()) +
+                               " nullable occurrences, more variants than the limit of " +
+                               to_string(productionLimit) + " productions");
+        }
+
+        seen.clear();
+        // mask 0 is de originele body; bit k gezet = k-de nullable voorkomen weglaten
+        const uint64_t variants = uint64_t(1) << nullablePositions.size();
+        for (uint64_t mask = 0; mask < variants; ++mask) {
+            newBody.clear();
+            size_t k = 0;
+            for (size_t i = 0; i < body.size(); ++i) {
+                if (k < nullablePositions.size() && nullablePositions[k] == i) {
+                    if (mask >> k++ & 1) continue;
                 }
+                newBody.push_back(body[i]);
             }
+            // Voeg alleen unieke en niet-lege producties toe
+            if (newBody.empty()) continue;
+            result.add(grammar.head(p), newBody.data(), newBody.size());
+            if (!seen.insert(static_cast<uint32_t>(result.size() - 1)).second) result.removeLast();
         }
-    } while (changed);
-
-    std::set<std::pair<std::string, std::string>> uniqueProductions;
-    int originalProdCount = 0;
-    for (const auto& rule : productionRules) {
-        originalProdCount += rule.second.size();
-        for (const auto& body : rule.second) {
-            if (!nonTerminals.count(body)) {
-                uniqueProductions.insert({rule.first, body});
-            }
+        if (result.size() > productionLimit) {
+            throw length_error("epsilon elimination: more than " + to_string(productionLimit) + " productions");
         }
     }
 
-    for (const auto& [A, B] : unitPairs) {
-        for (const auto& body : productionRules[B]) {
-            if (!nonTerminals.count(body)) {
-                uniqueProductions.insert({A, body});
+    // Stap 3: Log productietellingen
+    if (verbosity == Verbosity::Trace) {
+        cout << "  Created " << result.size() << " productions, original had " << grammar.productionCount() << "\n\n";
+    }
+
+    // Update de productie regels; dat de taal ε bevat, blijft enkel nog in de vlag over
+    if (grammar.startSymbol != SymbolTable::npos && nullable[grammar.startSymbol]) work.grammar.acceptsEmpty = true;
+    work.grammar.replaceProductions(move(result));
+}
+
+
+
+
+void CFG::eliminateUnitProductions(Work& work) {
+    const Grammar& grammar = work.grammar;
+    HeadIndex heads(grammar);
+    UnitClosure closure = computeUnitClosure(grammar, heads);
+
+    auto isUnit = [&](uint32_t p) {
+        Grammar::Body body = grammar.body(p);
+        return body.size() == 1 && grammar.isVariable(body[0]);
+    };
+    // Sorteersleutel per productie: rangen van de eerste twee symbolen (+1, 0 = geen symbool)
+    const vector<uint32_t> rank = nameRanks(grammar);
+    vector<uint64_t> key(rank.empty() ? 0 : grammar.productionCount());
+    for (size_t p = 0; p < key.size(); ++p) {
+        Grammar::Body body = grammar.body(p);
+        if (!body.empty()) key[p] = uint64_t(rank[body[0]] + 1) << 32 | (body.size() > 1 ? rank[body[1]] + 1 : 0);
+    }
+    auto byText = [&](uint32_t a, uint32_t b) {
+        Grammar::Body x = grammar.body(a), y = grammar.body(b);
+        if (rank.empty()) return bodyTextLess(grammar, x, y);
+        if (key[a] != key[b]) return key[a] < key[b];
+        return lexicographical_compare(x.begin(), x.end(), y.begin(), y.end(),
+                                       [&](Grammar::Id s, Grammar::Id t) { return rank[s] < rank[t]; });
+    };
+    auto sameText = [&](uint32_t a, uint32_t b) { return sameBody(grammar.body(a), grammar.body(b)); };
+
+    // Voor elk unit pair (A, B) alle niet-unit producties van B aan A toevoegen (zonder dubbels)
+    const bool trace = verbosity == Verbosity::Trace;
+    const vector<char> live = trace ? liveSymbols(work) : vector<char>();
+    ProductionBuffer result;
+    vector<pair<string_view, string_view>> unitPairs;
+    vector<uint32_t> bodies;
+    for (Grammar::Id A = 0; A < grammar.symbolCount(); ++A) {
+        if (!grammar.isVariable(A)) continue;
+        bodies.clear();
+        closure.forEach(A, [&](Grammar::Id B) {
+            if (trace && live[A]) unitPairs.emplace_back(grammar.symbols.name(A), grammar.symbols.name(B));
+            for (uint32_t i = heads.offsets[B]; i < heads.offsets[B + 1]; ++i) {
+                if (!isUnit(heads.productions[i])) bodies.push_back(heads.productions[i]);
             }
+        });
+        if (bodies.empty()) continue;
+
+        sort(bodies.begin(), bodies.end(), byText);
+        bodies.erase(unique(bodies.begin(), bodies.end(), sameText), bodies.end());
+        for (uint32_t p : bodies) {
+            Grammar::Body body = grammar.body(p);
+            result.add(A, body.begin(), body.size());
+        }
+        if (result.size() > productionLimit) {
+            throw length_error("unit elimination: more than " + to_string(productionLimit) + " productions");
         }
     }
 
-    // Converteer unieke producties terug naar map-structuur
-    productionRules.clear();
-    for (const auto& [head, body] : uniqueProductions) {
-        productionRules[head].push_back(body);
-    }
+    const size_t originalCount = grammar.productionCount();
+    const size_t newProdCount = result.size();
+    work.grammar.replaceProductions(move(result));
+    if (!trace) return;
 
-    postUnitProdCount = uniqueProductions.size();
+    sort(unitPairs.begin(), unitPairs.end(), [](const auto& x, const auto& y) {
+        return x.first != y.first ? x.first < y.first : x.second < y.second;
+    });
 
     std::cout << " >> Eliminating unit pairs\n";
-    std::cout << "  Found " << directUnitPairs.size() << " unit productions\n";
+    std::cout << "  Found " << closure.directUnitCount << " unit productions\n";
     std::cout << "  Unit pairs: {";
     for (auto it = unitPairs.begin(); it != unitPairs.end(); ++it) {
         std::cout << "(" << it->first << ", " << it->second << ")";
         if (std::next(it) != unitPairs.end()) std::cout << ", ";
     }
     std::cout << "}\n";
-    std::cout << "  Created " << uniqueProductions.size() << " new productions" << ", original had " << originalProdCount << "\n";
+    std::cout << "  Created " << newProdCount << " new productions" << ", original had " << originalCount << "\n";
 
 }
 
 
 
-void CFG::removeUselessSymbols() {
-    int initialVariableCount = nonTerminals.size();
-    int initialProdCount = postUnitProdCount;
-    int initialTerminalCount = terminals.size();
+void CFG::removeUselessSymbols(Work& work) {
+    const Grammar& grammar = work.grammar;
+    const bool trace = verbosity == Verbosity::Trace;
+    const vector<char> live = trace ? liveSymbols(work) : vector<char>();
+    int initialVariableCount = count(work.declared.begin(), work.declared.end(), 1);
+    int initialProdCount = grammar.productionCount();
 
-    // Stap 1: Genereerbare symbolen vinden (inclusief terminals)
-    set<string> generatingSymbols;
-    for (char terminal : terminals) {
-        generatingSymbols.insert(string(1, terminal));
-    }
-
-    bool changed;
-    do {
-        changed = false;
-        for (const auto& rule : productionRules) {
-            const string& head = rule.first;
-            for (const auto& body : rule.second) {
-                bool allGenerating = true;
-                for (char symbol : body) {
-                    string symStr(1, symbol);
-                    if (nonTerminals.count(symStr) && !generatingSymbols.count(symStr)) {
-                        allGenerating = false;
-                        break;
-                    }
-                }
-                if (allGenerating && generatingSymbols.insert(head).second) {
-                    changed = true;
-                }
-            }
-        }
-    } while (changed);
-
-    // Niet-genereerbare symbolen verwijderen
-    for (auto it = productionRules.begin(); it != productionRules.end();) {
-        if (!generatingSymbols.count(it->first)) {
-            it = productionRules.erase(it);
-        } else {
-            it->second.erase(remove_if(it->second.begin(), it->second.end(),
-                                       [&](const string& body) {
-                                           for (char symbol : body) {
-                                               if (nonTerminals.count(string(1, symbol)) && !generatingSymbols.count(string(1, symbol))) {
-                                                   return true;
-                                               }
-                                           }
-                                           return false;
-                                       }), it->second.end());
-            ++it;
-        }
-    }
+    // Stap 1: Genereerbare symbolen vinden (inclusief terminals), tellers per productie
+    vector<char> generating = computeGenerating(grammar, OccurrenceIndex(grammar));
 
-    // Bereikbare symbolen vinden (startend bij startSymbool)
-    set<string> reachableSymbols = {startSymbol};
-    queue<string> toProcess;
-    toProcess.push(startSymbol);
-    while (!toProcess.empty()) {
-        string current = toProcess.front();
-        toProcess.pop();
-        for (const auto& body : productionRules[current]) {
-            for (char symbol : body) {
-                string symStr(1, symbol);
-                if (terminals.count(symbol)) {
-                    reachableSymbols.insert(symStr); // Voeg terminal toe als hij wordt aangetroffen
-                } else if (nonTerminals.count(symStr) && reachableSymbols.insert(symStr).second) {
-                    toProcess.push(symStr);
-                }
-            }
-        }
-    }
+    // Stap 2: Bereikbare symbolen vinden (startend bij startSymbool), enkel via genererende producties
+    Bitset reachable = computeReachable(grammar, HeadIndex(grammar), generating);
 
-    // Niet-bereikbare symbolen verwijderen
-    for (auto it = productionRules.begin(); it != productionRules.end();) {
-        if (!reachableSymbols.count(it->first)) {
-            it = productionRules.erase(it);
-        } else {
-            it->second.erase(remove_if(it->second.begin(), it->second.end(),[&](const string& body) {
-                for (char symbol : body) {
-                    if (nonTerminals.count(string(1, symbol)) && !reachableSymbols.count(string(1, symbol))) {
-                        return true;
-                    }
-                }
-                return false;
-            }), it->second.end());
-            ++it;
+    // Stap 3: Producties filteren, in dezelfde volgorde
+    auto useful = [&](Grammar::Id id) { return generating[id] && reachable.test(id); };
+    ProductionBuffer result;
+    for (size_t p = 0; p < grammar.productionCount(); ++p) {
+        bool keep = useful(grammar.head(p));
+        for (Grammar::Id symbol : grammar.body(p)) {
+            if (!keep) break;
+            keep = generating[symbol];
         }
+        if (keep) result.add(grammar.head(p), grammar.body(p).begin(), grammar.body(p).size());
     }
 
-    // Verzamelen van overgebleven producties in een vector (inclusief duplicaten)
-    vector<pair<string, string>> remainingProductions;
-    for (const auto& rule : productionRules) {
-        for (const auto& body : rule.second) {
-            remainingProductions.push_back({rule.first, body});
-        }
+    // Update de gedeclareerde variabelen met de uiteindelijke bruikbare symbolen (exclusief terminals)
+    set<string> generatingSymbols, reachableSymbols, usefulSymbols;
+    for (Grammar::Id id = 0; id < grammar.symbolCount(); ++id) {
+        if (grammar.isVariable(id) && !useful(id)) work.declared[id] = 0;
+        if (!trace || !live[id]) continue;
+        const string name(grammar.symbols.name(id));
+        if (generating[id]) generatingSymbols.insert(name);
+        if (reachable.test(id)) reachableSymbols.insert(name);
+        if (useful(id)) usefulSymbols.insert(name);
     }
 
-    // Update nonTerminals met de uiteindelijke bruikbare symbolen (exclusief terminals)
-    set<string> usefulSymbols;
-    set_intersection(generatingSymbols.begin(), generatingSymbols.end(),
-                     reachableSymbols.begin(), reachableSymbols.end(),
-                     inserter(usefulSymbols, usefulSymbols.begin()));
-    nonTerminals.clear();
-    for (const auto& symbol : usefulSymbols) {
-        if (!terminals.count(symbol[0])) { // Voeg alleen niet-terminals toe aan V
-            nonTerminals.insert(symbol);
-        }
-    }
+    postUselessProdCount = result.size();
+    work.grammar.replaceProductions(move(result));
+    if (!trace) return;
 
     // Print resultaten
     cout << " >> Eliminating useless symbols\n";
@@ -392,187 +697,229 @@ void CFG::removeUselessSymbols() {
     }
     cout << "}\n";
 
-    // Verwijderde producties berekenen
-    int removedVariables = initialVariableCount - nonTerminals.size();
-    int removedTerminals = initialTerminalCount - terminals.size();
-    int remainingProdCount = 0;
-    for (const auto& rule : productionRules) {
-        remainingProdCount += rule.second.size();
-    }
-    int removedProductions = initialProdCount - remainingProdCount;
-    postUselessProdCount = remainingProdCount;
+    // Verwijderde producties berekenen (terminals worden hier nooit verwijderd)
+    int removedVariables = initialVariableCount - count(work.declared.begin(), work.declared.end(), 1);
+    int removedTerminals = 0;
+    int removedProductions = initialProdCount - postUselessProdCount;
     cout << "  Removed " << removedVariables << " variables, "<< removedTerminals <<" terminals and " << removedProductions << " productions\n\n";
 }
 
-void CFG::replaceTerminalsInBadBodies() {
-    // map of terminals to their corresponding non-terminals for direct replacements
-    map<char, string> terminalToNonTerminal = {
-            {'a', "A"},
-            {'b', "B"}
+void CFG::replaceTerminalsInBadBodies(Work& work) {
+    Grammar& grammar = work.grammar;
+    vector<char> live = liveSymbols(work);
+    auto taken = [&](const string& name) {
+        Grammar::Id id = grammar.symbols.find(name);
+        return id != SymbolTable::npos && live[id];
     };
 
-    map<char, string> terminalToVar;  // New variables for terminals without direct non-terminal replacements
-    int newVariableCount = 0;
-
-    // Process each production rule
-    for (auto& rule : productionRules) {
-        vector<string> updatedBodies;
-
-        for (const string& body : rule.second) {
-            // If the body is a single terminal, keep it as-is
-            if (body.size() == 1 && terminals.count(body[0])) {
-                updatedBodies.push_back(body);
-                continue;
-            }
-
-            string newBody;
-            bool bodyModified = false;
-            set<char> uniqueTerminals;  // Track unique terminals in the body
-
-            // first pass: collect unique terminals
-            for (char symbol : body) {
-                if (terminals.count(symbol)) {
-                    uniqueTerminals.insert(symbol);
-                }
-            }
-
-            // Determine if we need new variables
-            bool useNewVariables = uniqueTerminals.size() > 1;
-
-            // process each symbol in the body
-            for (char symbol : body) {
-                if (terminals.count(symbol) && body.size() >= 2) {
-                    if (useNewVariables) {
-                        // Create a new variable for this terminal if needed
-                        if (terminalToVar.find(symbol) == terminalToVar.end()) {
-                            string newVar = "_" + string(1, symbol);
-                            terminalToVar[symbol] = newVar;
-                            nonTerminals.insert(newVar);
-                            productionRules[newVar].push_back(string(1, symbol));
-                            newVariableCount++;
-                        }
-                        newBody += terminalToVar[symbol];
-                    } else if (terminalToNonTerminal.find(symbol) != terminalToNonTerminal.end()) {
-                        // replace with corresponding non-terminal if exists
-                        newBody += terminalToNonTerminal[symbol];
-                    }
-                    bodyModified = true;
-                } else {
-                    newBody += symbol;
-                }
-            }
+    // Per terminal de variabele "_t" die hem vervangt in bodies van lengte >= 2 (npos = nog niet nodig)
+    vector<Grammar::Id> terminalToVar(grammar.symbolCount(), SymbolTable::npos);
+    vector<pair<Grammar::Id, Grammar::Id>> newVariables;  // (variabele, terminal)
+    string name;
+    auto variableFor = [&](Grammar::Id terminal) {
+        if (terminalToVar[terminal] == SymbolTable::npos) {
+            name = "_";
+            name += grammar.name(terminal);
+            while (taken(name)) name.insert(0, 1, '_');
+            const Grammar::Id variable = addVariable(work, name);
+            if (variable >= live.size()) live.resize(variable + 1, 0);
+            live[variable] = 1;
+            terminalToVar[terminal] = variable;
+            newVariables.emplace_back(variable, terminal);
+        }
+        return terminalToVar[terminal];
+    };
 
-            // Add the modified or original body as needed
-            updatedBodies.push_back(bodyModified ? newBody : body);
+    // Process each production rule, symbool per symbool
+    ProductionBuffer result;
+    vector<Grammar::Id> newBody;
+    for (size_t p = 0; p < grammar.productionCount(); ++p) {
+        Grammar::Body body = grammar.body(p);
+        newBody.clear();
+        for (Grammar::Id symbol : body) {
+            newBody.push_back(body.size() >= 2 && !grammar.isVariable(symbol) ? variableFor(symbol) : symbol);
         }
-        rule.second = updatedBodies;
+        result.add(grammar.head(p), newBody.data(), newBody.size());
+    }
+    for (const auto& [variable, terminal] : newVariables) {
+        result.add(variable, &terminal, 1);
     }
+    const size_t originalCount = grammar.productionCount();
+    grammar.replaceProductions(move(result));
+    if (verbosity != Verbosity::Trace) return;
 
-    // Print resultss
-    cout << "    Added " << newVariableCount << " new variables: {";
-    for (auto it = terminalToVar.begin(); it != terminalToVar.end(); ++it) {
-        cout << it->second;
-        if (next(it) != terminalToVar.end()) cout << ", ";
+    // Print results
+    sort(newVariables.begin(), newVariables.end(), [&](const auto& x, const auto& y) {
+        return grammar.name(x.first) < grammar.name(y.first);
+    });
+    cout << "    Added " << newVariables.size() << " new variables: {";
+    for (auto it = newVariables.begin(); it != newVariables.end(); ++it) {
+        cout << grammar.name(it->first);
+        if (next(it) != newVariables.end()) cout << ", ";
     }
     cout << "}" << endl;
 
-    int totalProdCount = 0;
-    for (const auto& rule : productionRules) {
-        totalProdCount += rule.second.size();
-    }
-    cout << "    Created " << totalProdCount << " new productions, original had " << postUselessProdCount << "\n\n";
+    cout << "    Created " << originalCount + newVariables.size() << " new productions, original had "
+         << postUselessProdCount << "\n\n";
 }
 
 
 
 
 
-void CFG::breakLongBodies() {
-    map<string, vector<string>> newProductions;
-    map<string, int> varCount;  // Counter for each non-terminal to start from 2
+void CFG::breakLongBodies(Work& work) {
+    Grammar& grammar = work.grammar;
+    vector<char> live = liveSymbols(work);
+    vector<int> varCount(grammar.symbolCount(), 1);  // Teller per variabele; nieuwe namen beginnen bij _2
     int brokeCount = 0;  // Counter to track how many bodies were broken down
+    int addedCount = 0;
+
+    ProductionBuffer result;
+    string newVar;
+    for (size_t p = 0; p < grammar.productionCount(); ++p) {
+        const Grammar::Id head = grammar.head(p);
+        Grammar::Body body = grammar.body(p);
+
+        if (body.size() <= 2) {
+            // If body has 2 or fewer symbols, add it directly without modification
+            result.add(head, body.begin(), body.size());
+            continue;
+        }
 
-    // Iterate over all production rules
-    for (const auto& rule : productionRules) {
-        const string& head = rule.first;
-        varCount[head] = 1;  // Initialize the counter for this non-terminal to start from 1
-
-        for (const auto& body : rule.second) {
-            // Split the body into individual symbols
-            vector<string> parts;
-            istringstream iss(body);
-            string part;
-            while (iss >> part) {
-                parts.push_back(part);
-            }
-
-            if (parts.size() > 2) {
-                brokeCount++;
-                string currentHead = head;
-
-                // Process each segment of the body, creating a chain of new variables
-                for (size_t i = 0; i < parts.size() - 2; ++i) {
-                    string first = parts[i];
-                    string newVar = head + "_" + to_string(++varCount[head]);  // Generate new variable, starting from 2
-                    nonTerminals.insert(newVar);
-
-                    // Add the current production as `currentHead -> first newVar`
-                    newProductions[currentHead].push_back(first + " " + newVar);
-
-                    // Move to the next part, updating the head to newVar
-                    currentHead = newVar;
-                }
-
-                // The last segment (two symbols) is added as a final binary rule
-                newProductions[currentHead].push_back(parts[parts.size() - 2] + " " + parts[parts.size() - 1]);
-
-            } else {
-                // If body has 2 or fewer symbols, add it directly without modification
-                newProductions[head].push_back(body);
-            }
+        brokeCount++;
+        Grammar::Id currentHead = head;
+        // Process each segment of the body, creating a chain of new variables `currentHead -> first newVar`
+        for (size_t i = 0; i + 2 < body.size(); ++i) {
+            Grammar::Id var;
+            do {
+                newVar = grammar.name(head);
+                newVar += '_';
+                newVar += to_string(++varCount[head]);
+                var = grammar.symbols.find(newVar);
+            } while (var != SymbolTable::npos && live[var]);
+            var = addVariable(work, newVar);
+            if (var >= live.size()) live.resize(var + 1, 0);
+            live[var] = 1;
+            addedCount++;
+
+            const Grammar::Id pair[2] = {body[i], var};
+            result.add(currentHead, pair, 2);
+            currentHead = var;
         }
+
+        // The last segment (two symbols) is added as a final binary rule
+        result.add(currentHead, body.end() - 2, 2);
     }
 
     // Replace the old production rules with the new set
-    productionRules = newProductions;
+    grammar.replaceProductions(move(result));
 
-    cout << "\n >> Broke " << brokeCount << " bodies, added "
-         << accumulate(varCount.begin(), varCount.end(), 0, [](int sum, const std::pair<const std::string, int>& p) {
-             return sum + (p.second - 1);
-         })
-         << " new variables" << endl;
+    if (verbosity != Verbosity::Trace) return;
+    cout << "\n >> Broke " << brokeCount << " bodies, added " << addedCount << " new variables" << endl;
 }
 
 
 
 
 
-void CFG::toCNF() {
-    cout << "Original CFG:\n\n";
-    print();
-    cout << "\n-------------------------------------\n\n";
+// Hoogste geheugengebruik (resident set) van het proces tot nu toe
+static long peakResidentKiB() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+vector<CFG::PassReport> CFG::toCNF(Verbosity level, size_t limit) {
+    // Ook als een pass gooit (length_error) mogen verbosity en de limiet niet blijven hangen
+    struct Reset {
+        CFG& cfg;
+        ~Reset() {
+            cfg.verbosity = Verbosity::Silent;
+            cfg.productionLimit = 0;
+        }
+    } reset{*this};
+    verbosity = level;
+    productionLimit = limit;
+    const bool trace = level == Verbosity::Trace;
+    vector<PassReport> report;
+
+    // Alle passes werken op een kopie van de opslag (vaste ids, zie toGrammar), die pas op het
+    // einde de opslag vervangt
+    Work work = startWork();
+    auto symbolCount = [&] {
+        return static_cast<size_t>(count(work.declared.begin(), work.declared.end(), 1)) + terminals.size();
+    };
+    auto run = [&](const char* name, void (CFG::*pass)(Work&)) {
+        PassReport entry;
+        entry.pass = name;
+        entry.productionsIn = work.grammar.productionCount();
+        entry.symbolsIn = symbolCount();
+        auto begin = chrono::steady_clock::now();
+        (this->*pass)(work);
+        entry.seconds = chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+        entry.productionsOut = work.grammar.productionCount();
+        entry.symbolsOut = symbolCount();
+        entry.peakKiB = peakResidentKiB();
+        report.push_back(entry);
+    };
+    // Tussenstanden via een kopie: *this blijft ongewijzigd tot alle passes gelukt zijn
+    auto printWork = [&] {
+        CFG snapshot;
+        snapshot.terminals = terminals;
+        snapshot.startSymbol = startSymbol;
+        snapshot.finishWork(work);
+        snapshot.print();
+    };
 
-    cout << " >> Eliminating epsilon productions\n";
-    eliminateEpsilonProductions();
-    print();
+    if (trace) {
+        cout << "Original CFG:\n\n";
+        print();
+        cout << "\n-------------------------------------\n\n";
+        cout << " >> Eliminating epsilon productions\n";
+    }
+    run("epsilon", &CFG::eliminateEpsilonProductions);
+    if (trace) {
+        printWork();
+        cout << "\n";
+    }
 
-    cout << "\n";
-    eliminateUnitProductions();
-    cout << "\n";
-    print();
+    run("unit", &CFG::eliminateUnitProductions);
+    if (trace) {
+        cout << "\n";
+        printWork();
+        cout << "\n";
+    }
 
-    cout << "\n";
-    removeUselessSymbols();
-    print();
+    run("useless", &CFG::removeUselessSymbols);
+    if (trace) {
+        printWork();
+        cout << "\n >> Replacing terminals in bad bodies\n";
+    }
 
-    cout << "\n >> Replacing terminals in bad bodies\n";
     // ZORG DAT ALLE PRODUCTION BODIES MET EEN LENGTE >= 2 ENKEL BESTAAN UIT VARIABELEN
-    replaceTerminalsInBadBodies();
-    print();
+    run("terminals", &CFG::replaceTerminalsInBadBodies);
+    if (trace) printWork();
 
     //HERSCHRIJF ALLE PRODUCTION BODIES MET LENGTE >= 3 MET EXACT 2 VARIABELEN
-    breakLongBodies();
+    run("binarize", &CFG::breakLongBodies);
+    finishWork(move(work));
 
-    cout << ">>> Result CFG:\n\n";
-    print();
-}
\ No newline at end of file
+    if (trace) {
+        cout << ">>> Result CFG:\n\n";
+        print();
+    } else if (level == Verbosity::Report) {
+        printReport(report);
+    }
+    return report;
+}
+
+void CFG::printReport(const vector<PassReport>& report) {
+    // Een regel per pass, key=value, zodat logs eenvoudig te parsen zijn
+    for (const auto& entry : report) {
+        cout << "cnf pass=" << entry.pass
+             << " time_ms=" << fixed << setprecision(3) << entry.seconds * 1000 << defaultfloat
+             << " productions=" << entry.productionsIn << "->" << entry.productionsOut
+             << " symbols=" << entry.symbolsIn << "->" << entry.symbolsOut
+             << " peak_rss_kib=" << entry.peakKiB << '\n';
+    }
+}
@@ -9,33 +9,113 @@
 #include <iomanip>
 #include <fstream>
 #include "json.hpp"
+#include "Fingerprint.h"
+#include "Grammar.h"
+#include "OutputSink.h"
+
+class MappedGrammar;
 
 using namespace std;
 using namespace nlohmann;
 
+// Hoeveel toCNF logt: niets, enkel een rapport per pass, of alle tussenstappen
+enum class Verbosity { Silent, Report, Trace };
+
 class CFG {
 private:
 
-    int postUnitProdCount;
     int postUselessProdCount;
+    Verbosity verbosity = Verbosity::Silent;  // enkel gezet tijdens toCNF
+    size_t productionLimit = 0;               // idem
+
+    // Variabelen en producties staan geinterneerd: een naam een keer in de symbooltabel, bodies
+    // als ids. Soorten in store tellen niet; toGrammar leidt ze af zoals uit het JSON-schema.
+    Grammar store;
+    vector<char> declared;  // per symbool-id van store: staat in Variables
 
-    void eliminateEpsilonProductions();
-    void eliminateUnitProductions();
-    void removeUselessSymbols();
-    void replaceTerminalsInBadBodies();
-    void breakLongBodies();
+    // Werkvorm van toCNF: de passes blijven op ids, namen worden pas op het einde strings
+    struct Work {
+        Grammar grammar;
+        vector<char> declared;  // per symbool-id: staat in Variables
+    };
+
+    void load(istream &input);
+    vector<uint32_t> productionsByHead() const;  // Heads op naam, per head in volgorde van toevoegen
+    Work startWork() const;
+    void finishWork(Work work);
+    vector<char> liveSymbols(const Work &work) const;
+    static Grammar::Id addVariable(Work &work, string_view name);
+    void eliminateEpsilonProductions(Work &work);
+    void eliminateUnitProductions(Work &work);
+    void removeUselessSymbols(Work &work);
+    void replaceTerminalsInBadBodies(Work &work);
+    void breakLongBodies(Work &work);
+
+    static void writeProductionJSON(OutputSink &out, string_view head, string_view body);
 
 public:
+    // Meting van een CNF-pass: tijd, producties en symbolen voor/na, piek-RSS van het proces
+    struct PassReport {
+        string pass;
+        double seconds = 0;
+        size_t productionsIn = 0, productionsOut = 0;
+        size_t symbolsIn = 0, symbolsOut = 0;
+        long peakKiB = 0;
+    };
+
     CFG() = default;  // Constructor zonder parameter voor aanmaak via PDA
-    CFG(string Filename);
+    CFG(string Filename);  // JSON, JSONL of het binaire formaat van GrammarBinary.h (herkend aan de magic)
+    explicit CFG(istream &input);  // JSON of JSONL zoals het bestand; json-excepties bij een fout
+    explicit CFG(Grammar grammar);  // Neemt de geinterneerde vorm over: alle variabelen gedeclareerd
+    explicit CFG(const MappedGrammar &grammar);  // Rechtstreeks uit een gemapt binair bestand
 
-    set<string> nonTerminals;
     set<char> terminals;
-    map<string, vector<string>> productionRules;
     string startSymbol;
+    bool acceptsEmpty = false;  // Zie Grammar::acceptsEmpty; gezet door toCNF, "AcceptsEmpty" in JSON
 
-    void print();
-    void toCNF(); // Voegt de CNF-conversiemethode toe
+    // Zichten op de geinterneerde opslag; geldig tot de volgende wijziging van de CFG
+    vector<string_view> nonTerminals() const;  // Gesorteerd
+    size_t productionCount() const { return store.productionCount(); }
+    // f(head, body) per productie, body als "A b C"; heads op naam, per head in volgorde van toevoegen
+    template <typename F>
+    void forEachProduction(F f) const;
+
+    void addVariable(string_view name);                      // Zoals een naam in "Variables"
+    void addProduction(string_view head, string_view body);  // body: symbolen gescheiden door spaties
+
+    Grammar toGrammar() const;  // Kopie met vaste ids: variabelen, terminals, start, dan de heads op naam
+
+    set<string> computeNullable() const;  // Alle variabelen die ε kunnen afleiden
+    Fingerprint fingerprint() const;       // Onafhankelijk van de volgorde van de producties
+    void canonicalize();                   // Bodies per head gesorteerd: vaste volgorde bij gelijke fingerprint
+
+    void print() const;               // Naar stdout
+    void print(OutputSink &out) const; // Gebufferd, zonder alle regels als strings op te bouwen
+    void writeJSON(OutputSink &out) const;       // Schema van CFG(string Filename), zonder json-DOM
+    void writeJSONLines(OutputSink &out) const;  // Kopregel + een productie per regel
+    void writeBinary(OutputSink &out) const;     // Formaat van GrammarBinary.h
+    void write(OutputSink &out, const string &format) const;  // "json", "jsonl", "binary", anders tekst
+    // Bovengrens voor toCNF: de epsilon-pass kan per productie 2^k varianten maken (k nullable
+    // voorkomens) en de unit-pass kwadratisch groeien. Daarboven gooit toCNF std::length_error
+    // en blijft de grammatica ongewijzigd.
+    static constexpr size_t defaultProductionLimit = size_t(1) << 25;
+
+    vector<PassReport> toCNF(Verbosity verbosity = Verbosity::Report,
+                             size_t productionLimit = defaultProductionLimit); // Voegt de CNF-conversiemethode toe
+    static void printReport(const vector<PassReport> &report);
 };
 
+template <typename F>
+void CFG::forEachProduction(F f) const {
+    string body;
+    for (uint32_t p : productionsByHead()) {
+        body.clear();
+        for (Grammar::Id symbol : store.body(p)) {
+            if (!body.empty()) body += ' ';
+            body += store.name(symbol);
+        }
+        f(store.name(store.head(p)), string_view(body));
+    }
+}
+
 #endif //PROGRAMEEROPDRACHT1_CFG_H
\ No newline at end of file
@@ -0,0 +1,73 @@
+// Test van het wegschrijven en terug inlezen van een CFG: een CNF als JSON of JSONL moet na
+// CFG(istream) dezelfde grammatica zijn (fingerprint, ook acceptsEmpty) en CYK en Valiant
+// moeten het lege woord nog net zo beantwoorden als de PDA. De tekstvorm vermeldt de vlag.
+//
+//   ./PDA2CFG_cfg_test
+#include "CYK.h"
+#include "PDA.h"
+#include "Valiant.h"
+#include <sstream>
+
+namespace {
+    int failures = 0;
+
+    void fail(const std::string &message) {
+        std::cerr << "FAIL: " << message << std::endl;
+        ++failures;
+    }
+
+    // Dyck-woorden over a/b (met het lege woord) en a^n b^n met n >= 1 (zonder)
+    const std::string dyck = R"({"States": ["p"], "Alphabet": ["a", "b"], "StackAlphabet": ["Z", "A"],
+        "StartState": "p", "StartStack": "Z", "Transitions": [
+        {"from": "p", "input": "a", "stacktop": "Z", "to": "p", "replacement": ["A", "Z"]},
+        {"from": "p", "input": "a", "stacktop": "A", "to": "p", "replacement": ["A", "A"]},
+        {"from": "p", "input": "b", "stacktop": "A", "to": "p", "replacement": []},
+        {"from": "p", "input": "", "stacktop": "Z", "to": "p", "replacement": []}]})";
+    const std::string anbn = R"({"States": ["p", "q"], "Alphabet": ["a", "b"], "StackAlphabet": ["Z", "A"],
+        "StartState": "p", "StartStack": "Z", "Transitions": [
+        {"from": "p", "input": "a", "stacktop": "Z", "to": "p", "replacement": ["A"]},
+        {"from": "p", "input": "a", "stacktop": "A", "to": "p", "replacement": ["A", "A"]},
+        {"from": "p", "input": "b", "stacktop": "A", "to": "q", "replacement": []},
+        {"from": "q", "input": "b", "stacktop": "A", "to": "q", "replacement": []}]})";
+
+    std::string written(const CFG &cfg, const std::string &format) {
+        std::string text;
+        OutputSink out(&text);
+        cfg.write(out, format);
+        return text;
+    }
+
+    void check(const std::string &name, const std::string &json) {
+        std::istringstream input(json);
+        PDA pda(input);
+        CFG cnf = pda.toCFG(true);
+        cnf.toCNF(Verbosity::Silent);
+        const bool empty = pda.accepts("");
+        if (cnf.acceptsEmpty != empty) fail(name + ": toCNF lost the empty word");
+
+        for (const std::string format : {"json", "jsonl"}) {
+            const std::string where = name + " as " + format;
+            std::istringstream text(written(cnf, format));
+            const CFG loaded(text);
+            if (loaded.fingerprint() != cnf.fingerprint()) fail(where + ": round trip changed the grammar");
+            if (written(loaded, format) != written(cnf, format)) fail(where + ": writing it again differs");
+            if (CYK(loaded).accepts("") != empty) fail(where + ": CYK answers the empty word differently");
+            if (Valiant(loaded).accepts("") != empty) fail(where + ": Valiant answers the empty word differently");
+            if (CYK(loaded).accepts("ab") != pda.accepts("ab")) fail(where + ": CYK answers ab differently");
+        }
+        const bool mentioned = written(cnf, "text").find("AcceptsEmpty = true\n") != std::string::npos;
+        if (mentioned != empty) fail(name + ": text output " + (empty ? "misses" : "claims") + " the empty word");
+    }
+}
+
+int main() {
+    check("dyck", dyck);
+    check("anbn", anbn);
+
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "CNF round trips through JSON and JSONL keep the empty word" << std::endl;
+    return 0;
+}
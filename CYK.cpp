@@ -0,0 +1,141 @@
+#include "CYK.h"
+#include "Bitset.h"
+#include <algorithm>
+#include <chrono>
+#include <tuple>
+#include <type_traits>
+
+CYK::CYK(const CFG &cnf) {
+    build(cnf.toGrammar());
+}
+
+CYK::CYK(const MappedGrammar &cnf) {
+    build(cnf);
+}
+
+template <typename G>
+void CYK::build(const G &grammar) {
+    // Dichte nummering van de variabelen
+    std::vector<std::uint32_t> dense(grammar.symbolCount(), none);
+    for (Grammar::Id id = 0; id < grammar.symbolCount(); ++id) {
+        if (grammar.isVariable(id)) dense[id] = static_cast<std::uint32_t>(variableCount++);
+    }
+    wordsPerCell = (variableCount + 63) / 64;
+    if (grammar.startSymbol != SymbolTable::npos) start = dense[grammar.startSymbol];
+    acceptsEmpty = grammar.acceptsEmpty;
+
+    terminalCells.assign(256 * wordsPerCell, 0);
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>> binary;  // (B, C, A)
+    for (std::size_t p = 0; p < grammar.productionCount(); ++p) {
+        Grammar::Body body = grammar.body(p);
+        std::uint32_t A = dense[grammar.head(p)];
+        if (A == none) continue;  // terminaal als kop: geen regel van een CNF
+        if (body.size() == 1 && !grammar.isVariable(body[0])) {
+            std::string_view terminal = grammar.name(body[0]);
+            if (terminal.size() != 1) continue;
+            std::size_t cell = static_cast<unsigned char>(terminal[0]) * wordsPerCell;
+            terminalCells[cell + A / 64] |= std::uint64_t(1) << (A % 64);
+        } else if (body.size() == 2 && grammar.isVariable(body[0]) && grammar.isVariable(body[1])) {
+            binary.emplace_back(dense[body[0]], dense[body[1]], A);
+        }
+    }
+
+    std::sort(binary.begin(), binary.end());
+    binary.erase(std::unique(binary.begin(), binary.end()), binary.end());
+    leftOffsets.assign(variableCount + 1, 0);
+    for (std::size_t i = 0; i < binary.size(); ++i) {
+        auto [B, C, A] = binary[i];
+        if (pairs.empty() || i == 0 || std::get<0>(binary[i - 1]) != B || std::get<1>(binary[i - 1]) != C) {
+            pairs.push_back({C, static_cast<std::uint32_t>(heads.size()), 0});
+            ++leftOffsets[B + 1];
+        }
+        heads.push_back(A);
+        pairs.back().headsEnd = static_cast<std::uint32_t>(heads.size());
+    }
+    for (std::size_t B = 1; B < leftOffsets.size(); ++B) {
+        leftOffsets[B] += leftOffsets[B - 1];
+    }
+
+    if (wordsPerCell <= maskWords) {
+        headMasks.assign(pairs.size() * wordsPerCell, 0);
+        for (std::size_t q = 0; q < pairs.size(); ++q) {
+            for (std::uint32_t h = pairs[q].headsBegin; h < pairs[q].headsEnd; ++h) {
+                headMasks[q * wordsPerCell + heads[h] / 64] |= std::uint64_t(1) << (heads[h] % 64);
+            }
+        }
+    }
+}
+
+template <std::size_t Words>
+void CYK::fillCell(std::uint64_t *table, const std::vector<std::size_t> &rowStart, std::size_t len,
+                   std::size_t i) const {
+    const std::size_t W = Words ? Words : wordsPerCell;
+    std::uint64_t *target = table + (rowStart[len] + i) * W;
+    for (std::size_t k = 1; k < len; ++k) {
+        const std::uint64_t *left = table + (rowStart[k] + i) * W;
+        const std::uint64_t *right = table + (rowStart[len - k] + i + k) * W;
+        if (!BitWords<Words>::any(right, W)) continue;
+        for (std::size_t w = 0; w < W; ++w) {
+            for (std::uint64_t word = left[w]; word; word &= word - 1) {
+                std::size_t B = w * 64 + __builtin_ctzll(word);
+                for (std::uint32_t q = leftOffsets[B]; q < leftOffsets[B + 1]; ++q) {
+                    const Pair &pair = pairs[q];
+                    if (!(right[pair.right / 64] >> (pair.right % 64) & 1)) continue;
+                    if constexpr (Words != 0 && Words <= maskWords) {
+                        BitWords<Words>::orInto(target, headMasks.data() + q * Words);
+                    } else {
+                        for (std::uint32_t h = pair.headsBegin; h < pair.headsEnd; ++h) {
+                            target[heads[h] / 64] |= std::uint64_t(1) << (heads[h] % 64);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+CYK::Run CYK::run(const std::string &input, ThreadPool *pool) const {
+    auto begin = std::chrono::steady_clock::now();
+    const std::size_t n = input.size();
+    const std::size_t W = wordsPerCell;
+    bool accepted = n == 0 && acceptsEmpty;
+
+    if (n > 0 && start != none) {
+        // Rij per lengte len (1..n) met n - len + 1 cellen, alle cellen plat achter elkaar
+        std::vector<std::size_t> rowStart(n + 1, 0);
+        for (std::size_t len = 1; len < n; ++len) {
+            rowStart[len + 1] = rowStart[len] + (n - len + 1);
+        }
+        std::vector<std::uint64_t> table((rowStart[n] + 1) * W, 0);
+        auto cell = [&](std::size_t len, std::size_t i) { return table.data() + (rowStart[len] + i) * W; };
+
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::uint64_t *terminal = terminalCells.data() + static_cast<unsigned char>(input[i]) * W;
+            std::copy(terminal, terminal + W, cell(1, i));
+        }
+
+        // Celbreedte als template-argument zodat de woordlussen vast liggen
+        auto fill = [&](auto width) {
+            constexpr std::size_t Words = decltype(width)::value;
+            for (std::size_t len = 2; len <= n; ++len) {
+                if (pool) {
+                    pool->parallelFor(0, n - len + 1,
+                                      [&](std::size_t i) { fillCell<Words>(table.data(), rowStart, len, i); });
+                } else {
+                    for (std::size_t i = 0; i + len <= n; ++i) fillCell<Words>(table.data(), rowStart, len, i);
+                }
+            }
+        };
+        switch (W) {
+            case 1: fill(std::integral_constant<std::size_t, 1>()); break;
+            case 2: fill(std::integral_constant<std::size_t, 2>()); break;
+            case 4: fill(std::integral_constant<std::size_t, 4>()); break;
+            case 8: fill(std::integral_constant<std::size_t, 8>()); break;
+            default: fill(std::integral_constant<std::size_t, 0>()); break;
+        }
+        accepted = cell(n, 0)[start / 64] >> (start % 64) & 1;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return {accepted, elapsed.count()};
+}
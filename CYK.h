@@ -0,0 +1,61 @@
+#ifndef CYK_H
+#define CYK_H
+
+#include "CFG.h"
+#include "GrammarBinary.h"
+#include "Recognizer.h"
+#include "ThreadPool.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// CYK-herkenner voor een grammatica in Chomsky-normaalvorm (output van CFG::toCNF). De lege
+// invoer kan de CNF zelf niet afleiden; die wordt beantwoord met Grammar::acceptsEmpty.
+// Cellen zijn bitsets over de variabelen; voor elke variabele B staat een omgekeerde index
+// van paren (B, C) naar alle heads A met A -> B C. Niet-CNF producties worden genegeerd.
+// Is een cel 1, 2, 4 of 8 woorden breed (tot 64, 128, 256 of 512 variabelen), dan is die
+// breedte een template-argument (BitWords); bij 1 of 2 woorden worden de heads van een paar
+// als een masker ge-OR'd in plaats van bit per bit gezet.
+class CYK {
+public:
+    using Run = RecognitionRun;
+
+    explicit CYK(const CFG &cnf);
+    explicit CYK(const MappedGrammar &cnf);  // rechtstreeks uit een gemapt binair bestand
+
+    bool accepts(const std::string &input, ThreadPool *pool = nullptr) const { return run(input, pool).accepted; }
+
+    // Herkenning met tijdmeting. Met een pool worden de cellen van elke diagonaal
+    // (zelfde spanlengte) parallel gevuld; ze hangen enkel af van kortere spans.
+    Run run(const std::string &input, ThreadPool *pool = nullptr) const;
+
+private:
+    struct Pair {
+        std::uint32_t right;       // C in A -> B C
+        std::uint32_t headsBegin;  // heads[headsBegin, headsEnd)
+        std::uint32_t headsEnd;
+    };
+
+    static constexpr std::uint32_t none = UINT32_MAX;
+    static constexpr std::size_t maskWords = 2;
+
+    template <typename G>
+    void build(const G &grammar);
+
+    // Cel (len, i) van de platte tabel invullen uit alle splitsingen (k, len - k);
+    // Words = wordsPerCell, of 0 voor een dynamische breedte
+    template <std::size_t Words>
+    void fillCell(std::uint64_t *table, const std::vector<std::size_t> &rowStart, std::size_t len, std::size_t i) const;
+
+    std::size_t variableCount = 0;
+    std::size_t wordsPerCell = 0;
+    std::uint32_t start = none;
+    bool acceptsEmpty = false;
+    std::vector<std::uint64_t> terminalCells;  // 256 cellen: variabelen A met A -> c
+    std::vector<std::uint32_t> leftOffsets;    // B = pairs[leftOffsets[B], leftOffsets[B+1])
+    std::vector<Pair> pairs;
+    std::vector<std::uint32_t> heads;
+    std::vector<std::uint64_t> headMasks;  // per paar wordsPerCell woorden, enkel als wordsPerCell <= maskWords
+};
+
+#endif // CYK_H
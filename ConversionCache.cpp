@@ -0,0 +1,60 @@
+#include "ConversionCache.h"
+#include <atomic>
+#include <cstdio>
+#include <unistd.h>
+
+ConversionCache::ConversionCache(std::filesystem::path directory) : directory(std::move(directory)) {
+    std::error_code error;
+    std::filesystem::create_directories(this->directory, error);
+}
+
+std::filesystem::path ConversionCache::pathFor(const Fingerprint &input, std::string_view stage) const {
+    // Versie en stap in de sleutel; de stap staat er ook leesbaar achter
+    std::string name = FingerprintBuilder().add(conversionVersion).add(input).add(stage).finish().hex();
+    name += '.';
+    name += stage;
+    name += ".bin";
+    return directory / name;
+}
+
+std::unique_ptr<MappedGrammar> ConversionCache::find(const Fingerprint &input, std::string_view stage) const {
+    // store() heeft het bestand al volledig gecontroleerd (checksum, ids): hier enkel de header
+    return MappedGrammar::tryOpen(pathFor(input, stage).string(), true);
+}
+
+bool ConversionCache::store(const Fingerprint &input, std::string_view stage, const Grammar &grammar) const {
+    static std::atomic<unsigned> counter{0};
+    const std::filesystem::path target = pathFor(input, stage);
+    std::filesystem::path temporary = target;
+    temporary += ".tmp." + std::to_string(getpid()) + "." + std::to_string(counter++);
+
+    std::FILE *file = std::fopen(temporary.string().c_str(), "wb");
+    if (!file) return false;
+    {
+        OutputSink out(file);
+        writeGrammarBinary(grammar, out);
+    }
+    const bool written = std::ferror(file) == 0;
+    if (std::fclose(file) != 0 || !written || !MappedGrammar::tryOpen(temporary.string())) {
+        std::remove(temporary.string().c_str());
+        return false;
+    }
+
+    std::error_code error;
+    std::filesystem::rename(temporary, target, error);
+    if (!error) return true;
+    std::filesystem::remove(temporary, error);
+    return false;
+}
+
+CFG convertPDA(PDA &pda, bool pruned, ThreadPool *pool, const ConversionCache *cache, std::size_t productionLimit) {
+    if (!cache) return pda.toCFG(pruned, pool, productionLimit);
+    const Fingerprint key = pda.fingerprint();
+    const char *stage = pruned ? "cfg-pruned" : "cfg";
+    if (auto hit = cache->find(key, stage)) return CFG(hit->toGrammar());
+    // toCFG is al canoniek: een treffer is gelijk aan wat een miss of een run zonder cache
+    // geeft, ook voor dezelfde PDA in een andere volgorde
+    Grammar canonical = pda.toCFG(pruned, pool, productionLimit).toGrammar();
+    cache->store(key, stage, canonical);
+    return CFG(canonical);  // zelfde weg als een treffer
+}
@@ -0,0 +1,45 @@
+#ifndef CONVERSIONCACHE_H
+#define CONVERSIONCACHE_H
+
+#include "Fingerprint.h"
+#include "GrammarBinary.h"
+#include "PDA.h"
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+// Lokale cache van conversieresultaten, geadresseerd op inhoud: een grammatica staat in
+// <map>/<fingerprint van de invoer>.<stap>.bin in het binaire formaat van GrammarBinary.h,
+// zodat een treffer enkel een mmap is. Stappen zijn vrije namen ("cfg", "cfg-pruned", "cnf").
+// Schrijven gaat via een tijdelijk bestand en rename, zodat parallelle processen nooit een
+// half bestand zien. De fingerprint negeert de volgorde van de invoer, dus elke conversie werkt
+// in canonieke vorm (CFG::canonicalize, voor toCNF al op de invoer), ook zonder cache: een
+// treffer is dan exact wat de conversie voor elke volgorde van dezelfde invoer geeft. store()
+// controleert het geschreven bestand volledig, find() daarna enkel header en sectiegrenzen.
+//
+// De bestandsnaam hangt ook af van conversionVersion: verhogen bij elke wijziging die het
+// resultaat van een stap verandert (producties, volgorde, namen van verse variabelen), zodat
+// oude bestanden niet meer gevonden worden. Een ander binair formaat weigert MappedGrammar al.
+class ConversionCache {
+public:
+    static constexpr std::uint64_t conversionVersion = 2;
+
+    explicit ConversionCache(std::filesystem::path directory);
+
+    // nullptr bij een miss (of een onleesbaar bestand)
+    std::unique_ptr<MappedGrammar> find(const Fingerprint &input, std::string_view stage) const;
+    // false als het bestand niet geschreven kon worden; de cache is dan enkel trager
+    bool store(const Fingerprint &input, std::string_view stage, const Grammar &grammar) const;
+
+private:
+    std::filesystem::path directory;
+
+    std::filesystem::path pathFor(const Fingerprint &input, std::string_view stage) const;
+};
+
+// PDA -> CFG, via de cache als die er is (cache mag nullptr zijn); productionLimit zoals PDA::toCFG
+CFG convertPDA(PDA &pda, bool pruned, ThreadPool *pool, const ConversionCache *cache,
+               std::size_t productionLimit = SIZE_MAX);
+
+#endif // CONVERSIONCACHE_H
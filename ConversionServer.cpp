@@ -0,0 +1,509 @@
+#include "ConversionServer.h"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#include <streambuf>
+#include <thread>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+    constexpr std::size_t maxHeaderBytes = 4096;
+    constexpr std::size_t receiveChunk = std::size_t(64) << 10;
+    constexpr std::size_t maxSpareBytes = std::size_t(1) << 20;  // grotere buffers na een verzoek vrijgeven
+    constexpr long acceptRetryNanoseconds = 100'000'000;
+
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void requestStop(int) { stopRequested = 1; }
+
+    // Leest een verzoek rechtstreeks uit de ontvangstbuffer, zonder kopie
+    class MemoryBuffer : public std::streambuf {
+    public:
+        explicit MemoryBuffer(std::string_view data) {
+            char *begin = const_cast<char *>(data.data());
+            setg(begin, begin, begin + data.size());
+        }
+    };
+
+    bool sendAll(int fd, const char *data, std::size_t size, int flags = 0) {
+        while (size > 0) {
+            ssize_t sent = send(fd, data, size, flags | MSG_NOSIGNAL);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return false;
+            data += sent;
+            size -= static_cast<std::size_t>(sent);
+        }
+        return true;
+    }
+
+    bool sendError(int fd, std::string message, int flags = 0) {
+        for (char &c : message) {
+            if (c == '\n' || c == '\r') c = ' ';
+        }
+        message = "error " + message + "\n";
+        return sendAll(fd, message.data(), message.size(), flags);
+    }
+
+    // Lege string als de kopregel geldig is, anders de foutboodschap
+    template <typename Request>
+    std::string parseHeader(std::string_view line, Request &request) {
+        std::istringstream fields{std::string(line)};
+        std::string bytes, option;
+        if (!(fields >> request.kind >> bytes)) return "expected '<pda|cfg> <bytes> [options]'";
+        if (request.kind != "pda" && request.kind != "cfg" && request.kind != "add" && request.kind != "remove") {
+            return "unknown kind '" + request.kind + "'";
+        }
+        if (bytes.empty() || bytes.find_first_not_of("0123456789") != std::string::npos || bytes.size() > 12) {
+            return "invalid byte count '" + bytes + "'";
+        }
+        request.bytes = std::stoull(bytes);
+        if (request.bytes > ConversionServer::maxRequestBytes) return "request larger than " +
+            std::to_string(ConversionServer::maxRequestBytes) + " bytes";
+        while (fields >> option) {
+            if (option == "pruned") {
+                request.pruned = true;
+            } else if (option == "cnf") {
+                request.cnf = true;
+            } else if (option == "incremental" && request.kind == "cfg") {
+                request.incremental = true;
+            } else if (option.rfind("format=", 0) == 0) {
+                request.format = option.substr(7);
+                if (request.format != "text" && request.format != "json" && request.format != "jsonl" &&
+                    request.format != "binary") {
+                    return "unknown format '" + request.format + "'";
+                }
+            } else {
+                return "unknown option '" + option + "'";
+            }
+        }
+        if (request.pruned && (request.kind != "pda" || request.cnf)) {
+            return "option 'pruned' only applies to 'pda' without 'cnf' (cnf always starts from the pruned grammar)";
+        }
+        return {};
+    }
+
+    // CNF van een grammatica, via de cache als die er is
+    template <typename Source>
+    CFG cachedCNF(const ConversionCache *cache, const Fingerprint &key, const char *stage, Source source) {
+        if (cache) {
+            if (auto hit = cache->find(key, stage)) return CFG(hit->toGrammar());
+        }
+        CFG cnf = source();
+        cnf.canonicalize();  // de sleutel negeert de volgorde, het resultaat dan ook, met of zonder cache
+        cnf.toCNF(Verbosity::Silent, ConversionServer::maxProductions);
+        if (cache) cache->store(key, stage, cnf.toGrammar());
+        return cnf;
+    }
+
+    // Wijzigingen uit een add/remove-verzoek: "A -> a B", een productie per regel
+    std::vector<std::pair<std::string, std::string>> parseProductions(std::string_view body) {
+        std::vector<std::pair<std::string, std::string>> productions;
+        auto trim = [](std::string_view text) {
+            const std::size_t first = text.find_first_not_of(" \t\r");
+            if (first == std::string_view::npos) return std::string_view();
+            return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+        };
+        while (!body.empty()) {
+            std::size_t end = body.find('\n');
+            if (end == std::string_view::npos) end = body.size();
+            std::string_view line = trim(body.substr(0, end));
+            body.remove_prefix(std::min(end + 1, body.size()));
+            if (line.empty()) continue;
+
+            const std::size_t arrow = line.find("->");
+            std::string_view head = trim(line.substr(0, std::min(arrow, line.size())));
+            if (arrow == std::string_view::npos || head.empty() || head.find_first_of(" \t") != std::string_view::npos) {
+                throw std::runtime_error("expected '<head> -> <symbols>', got '" + std::string(line) + "'");
+            }
+            // Symbolen gescheiden door een spatie, zoals in CFG::addProduction
+            std::string symbols;
+            std::istringstream tokens{std::string(line.substr(arrow + 2))};
+            for (std::string token; tokens >> token;) {
+                if (!symbols.empty()) symbols += ' ';
+                symbols += token;
+            }
+            productions.emplace_back(head, std::move(symbols));
+        }
+        return productions;
+    }
+
+    // Alles of niets: bij een fout worden de eerdere wijzigingen van hetzelfde verzoek omgekeerd
+    void edit(IncrementalCNF &grammar, bool add, std::string_view body) {
+        const auto productions = parseProductions(body);
+        std::vector<std::size_t> applied;
+        try {
+            for (std::size_t i = 0; i < productions.size(); ++i) {
+                const auto &[head, symbols] = productions[i];
+                if (add ? grammar.addProduction(head, symbols) : grammar.removeProduction(head, symbols)) {
+                    applied.push_back(i);
+                }
+            }
+        } catch (const std::length_error &) {
+            // Elke vorige toestand bleef binnen de grens: terugdraaien gooit zelf niet
+            for (auto it = applied.rbegin(); it != applied.rend(); ++it) {
+                const auto &[head, symbols] = productions[*it];
+                add ? grammar.removeProduction(head, symbols) : grammar.addProduction(head, symbols);
+            }
+            throw;
+        }
+    }
+}
+
+ConversionServer::ConversionServer(std::string socketPath, std::size_t workers, const ConversionCache *cache)
+        : socketPath(std::move(socketPath)), workers(workers), cache(cache) {}
+
+void ConversionServer::convert(const Request &request, std::string_view body, std::optional<IncrementalCNF> &session,
+                               std::string &payload) const {
+    MemoryBuffer buffer(body);
+    std::istream input(&buffer);
+
+    CFG cfg;
+    if (request.kind == "add" || request.kind == "remove") {
+        if (!session) throw std::runtime_error("no grammar to edit; send 'cfg <bytes> incremental' first");
+        edit(*session, request.kind == "add", body);
+        // Enkel het verschil, ongeacht format: evenredig met de wijziging, niet met de grammatica
+        for (const auto &change : session->takeChanges()) {
+            payload += change.added ? "+ " : "- ";
+            payload += change.head;
+            payload += " ->";
+            for (const auto &symbol : change.body) {
+                payload += ' ';
+                payload += symbol;
+            }
+            payload += '\n';
+        }
+        return;
+    } else if (request.incremental) {
+        // Pas vervangen als de nieuwe grammatica volledig geladen is
+        session = IncrementalCNF(CFG(input), maxProductions);
+        session->takeChanges();  // het antwoord is de volledige CNF
+        cfg = session->toCFG();
+    } else if (request.kind == "pda") {
+        PDA pda(input);
+        if (request.cnf) {
+            // Zelfde sleutel en stap als --cyk/--save-cnf met --cache
+            cfg = cachedCNF(cache, cache ? pda.fingerprint() : Fingerprint{}, "cnf",
+                            [&] { return pda.toCFG(true, nullptr, maxProductions); });
+        } else {
+            cfg = convertPDA(pda, request.pruned, nullptr, cache, maxProductions);
+        }
+    } else {
+        CFG source(input);
+        if (request.cnf) {
+            cfg = cachedCNF(cache, cache ? source.fingerprint() : Fingerprint{}, "cfg-cnf",
+                            [&] { return std::move(source); });
+        } else {
+            cfg = std::move(source);
+        }
+    }
+
+    OutputSink out(&payload);
+    cfg.write(out, request.format);
+}
+
+void ConversionServer::handle(Connection &connection) {
+    // Per worker, over verzoeken heen: de capaciteit blijft staan, tot maxSpareBytes
+    thread_local std::string payload;
+    payload.clear();
+    if (payload.capacity() > maxSpareBytes) payload = std::string();
+
+    const Request request = *connection.request;
+    const std::size_t end = connection.bodyStart + request.bytes;
+    std::string error;
+    try {
+        convert(request, std::string_view(connection.input).substr(connection.bodyStart, request.bytes),
+                connection.session, payload);
+    } catch (const std::exception &exception) {
+        error = exception.what();
+    }
+    // Wat na het verzoek binnenkwam, is het begin van het volgende
+    std::memmove(connection.input.data(), connection.input.data() + end, connection.filled - end);
+    connection.filled -= end;
+    connection.request.reset();
+
+    bool keep;
+    if (!error.empty()) {
+        keep = sendError(connection.fd, error);
+    } else {
+        const std::string header = "ok " + std::to_string(payload.size()) + "\n";
+        keep = sendAll(connection.fd, header.data(), header.size(), MSG_MORE) &&
+               sendAll(connection.fd, payload.data(), payload.size());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(finishedMutex);
+        finished.emplace_back(connection.fd, keep);
+    }
+    const std::uint64_t one = 1;
+    while (write(wakeFd, &one, sizeof(one)) < 0 && errno == EINTR) {
+    }
+}
+
+int ConversionServer::listen() {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (socketPath.empty() || socketPath.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Invalid socket path " << socketPath << std::endl;
+        return -1;
+    }
+    std::memcpy(address.sun_path, socketPath.c_str(), socketPath.size() + 1);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) {
+        std::cerr << "Could not create socket: " << std::strerror(errno) << std::endl;
+        return -1;
+    }
+    bool bound = bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+    if (!bound && errno == EADDRINUSE) {
+        // Een socketbestand van een vorige, gestopte server mag weg; een luisterende server niet
+        int probe = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        const bool alive = connect(probe, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+        close(probe);
+        if (alive) {
+            std::cerr << "Socket " << socketPath << " is in use by another server" << std::endl;
+            close(fd);
+            return -1;
+        }
+        unlink(socketPath.c_str());
+        bound = bind(fd, reinterpret_cast<sockaddr *>(&address), sizeof(address)) == 0;
+    }
+    if (!bound || ::listen(fd, SOMAXCONN) < 0) {
+        std::cerr << "Could not listen on " << socketPath << ": " << std::strerror(errno) << std::endl;
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+int ConversionServer::run() {
+    const int listener = listen();
+    if (listener < 0) return 1;
+    wakeFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    if (wakeFd < 0) {
+        std::cerr << "Could not create eventfd: " << std::strerror(errno) << std::endl;
+        close(listener);
+        unlink(socketPath.c_str());
+        return 1;
+    }
+
+    // SIGINT/SIGTERM enkel binnen ppoll toelaten: de workers (na het blokkeren gestart) krijgen
+    // ze nooit, en een signaal tussen de controle en het wachten gaat niet verloren
+    stopRequested = 0;
+    struct sigaction action{}, oldInt{}, oldTerm{};
+    action.sa_handler = requestStop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, &oldInt);
+    sigaction(SIGTERM, &action, &oldTerm);
+    sigset_t blocked, original;
+    sigemptyset(&blocked);
+    sigaddset(&blocked, SIGINT);
+    sigaddset(&blocked, SIGTERM);
+    pthread_sigmask(SIG_BLOCK, &blocked, &original);
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::duration idle = std::chrono::seconds(idleSeconds);
+    int status = 0;
+    {
+        // Queue 0 hoort bij deze thread, die enkel accepteert en leest: workers + 1 threads
+        if (workers == 0) workers = std::max(1u, std::thread::hardware_concurrency());
+        ThreadPool pool(workers + 1);
+        std::cout << "Serving on " << socketPath << " with " << workers << " workers" << std::endl;
+
+        std::map<int, std::unique_ptr<Connection>> connections;
+        std::vector<std::string> spareBuffers;  // leesbuffers van verbindingen zonder ontvangen bytes
+        std::vector<pollfd> waiting;
+        Clock::time_point starvedUntil{};  // geen descriptors of geheugen meer voor nieuwe verbindingen
+        bool starved = false;
+
+        // Een lege leesbuffer gaat naar de reserve, of wordt vrijgegeven als hij groter is dan
+        // maxSpareBytes: een verzoek van 256 MB mag niet blijven wegen zolang de server loopt
+        auto release = [&](Connection &connection) {
+            if (connection.filled != 0 || connection.input.capacity() == 0) return;
+            if (connection.input.capacity() > maxSpareBytes) {
+                connection.input = std::string();
+            } else if (spareBuffers.size() < workers) {
+                spareBuffers.push_back(std::move(connection.input));
+                connection.input = std::string();
+            }
+        };
+        auto closeConnection = [&](std::map<int, std::unique_ptr<Connection>>::iterator it) {
+            it->second->filled = 0;
+            release(*it->second);
+            close(it->first);
+            return connections.erase(it);
+        };
+        // Leest wat er klaarstaat, zonder te blokkeren; false als de verbinding dicht moet
+        auto receiveFrom = [&](Connection &connection) {
+            if (connection.input.empty() && !spareBuffers.empty()) {
+                connection.input = std::move(spareBuffers.back());
+                spareBuffers.pop_back();
+            }
+            // Kopregel in blokken; de body kreeg in advance al in een keer zijn volle lengte
+            if (connection.input.size() == connection.filled) connection.input.resize(connection.filled + receiveChunk);
+            ssize_t received;
+            do {
+                received = recv(connection.fd, connection.input.data() + connection.filled,
+                                connection.input.size() - connection.filled, MSG_DONTWAIT);
+            } while (received < 0 && errno == EINTR);
+            if (received < 0) return errno == EAGAIN || errno == EWOULDBLOCK;
+            if (received == 0) return false;
+            connection.filled += static_cast<std::size_t>(received);
+            connection.lastActive = Clock::now();
+            return true;
+        };
+        // Geeft een volledig ontvangen verzoek aan de pool; false als de verbinding dicht moet
+        auto advance = [&](Connection &connection) {
+            if (!connection.request) {
+                const std::string_view received(connection.input.data(), connection.filled);
+                const std::size_t newline = received.find('\n');
+                if (newline == std::string_view::npos) {
+                    if (connection.filled <= maxHeaderBytes) return true;
+                    sendError(connection.fd, "header line too long", MSG_DONTWAIT);
+                    return false;
+                }
+                Request request;
+                std::string error = parseHeader(received.substr(0, newline), request);
+                if (!error.empty()) {
+                    // Zonder geldige lengte is de grens met het volgende verzoek onbekend: verbinding sluiten
+                    sendError(connection.fd, error, MSG_DONTWAIT);
+                    return false;
+                }
+                connection.request = request;
+                connection.bodyStart = newline + 1;
+            }
+            const std::size_t end = connection.bodyStart + connection.request->bytes;
+            if (connection.filled < end) {
+                // Een keer op volle lengte brengen en daarna rechtstreeks in de buffer ontvangen
+                if (connection.input.size() < end) connection.input.resize(end);
+                return true;
+            }
+            connection.busy = true;
+            Connection *target = &connection;
+            pool.submit([this, target] { handle(*target); });
+            return true;
+        };
+
+        while (!stopRequested) {
+            const Clock::time_point now = Clock::now();
+            waiting.clear();
+            waiting.push_back({wakeFd, POLLIN, 0});
+            const bool accepting = now >= starvedUntil;
+            if (accepting) waiting.push_back({listener, POLLIN, 0});
+            const std::size_t firstClient = waiting.size();
+            Clock::time_point deadline = accepting ? Clock::time_point::max() : starvedUntil;
+            for (const auto &[fd, connection] : connections) {
+                if (connection->busy) continue;
+                waiting.push_back({fd, POLLIN, 0});
+                deadline = std::min(deadline, connection->lastActive + idle);
+            }
+            // Wakker worden voor de eerste verbinding die te lang stil is, of om weer te accepteren
+            timespec timeout{};
+            const bool bounded = deadline != Clock::time_point::max();
+            if (bounded) {
+                const Clock::duration wait = std::max(deadline - now, Clock::duration::zero());
+                const long long left = std::chrono::duration_cast<std::chrono::nanoseconds>(wait).count();
+                timeout.tv_sec = static_cast<time_t>(left / 1'000'000'000);
+                timeout.tv_nsec = static_cast<long>(left % 1'000'000'000);
+            }
+            if (ppoll(waiting.data(), waiting.size(), bounded ? &timeout : nullptr, &original) < 0) {
+                if (errno == EINTR) continue;  // stopRequested controleren
+                std::cerr << "Could not poll " << socketPath << ": " << std::strerror(errno) << std::endl;
+                status = 1;
+                break;
+            }
+
+            if (waiting[0].revents != 0) {
+                std::uint64_t count;
+                while (read(wakeFd, &count, sizeof(count)) < 0 && errno == EINTR) {
+                }
+                std::vector<std::pair<int, bool>> done;
+                {
+                    std::lock_guard<std::mutex> lock(finishedMutex);
+                    done.swap(finished);
+                }
+                for (const auto &[fd, keep] : done) {
+                    auto it = connections.find(fd);
+                    Connection &connection = *it->second;
+                    connection.busy = false;
+                    connection.lastActive = Clock::now();
+                    // Een volgend verzoek kan al volledig in de buffer staan
+                    if (!keep || !advance(connection)) {
+                        closeConnection(it);
+                    } else if (!connection.busy) {
+                        release(connection);
+                    }
+                }
+            }
+
+            for (std::size_t i = firstClient; i < waiting.size(); ++i) {
+                if (waiting[i].revents == 0) continue;
+                auto it = connections.find(waiting[i].fd);
+                if (it == connections.end() || it->second->busy) continue;
+                if (!receiveFrom(*it->second) || !advance(*it->second)) closeConnection(it);
+            }
+
+            if (accepting && waiting[1].revents != 0) {
+                int client = accept4(listener, nullptr, nullptr, SOCK_CLOEXEC);
+                if (client >= 0) {
+                    starved = false;
+                    // Een client die zijn antwoord niet leest, houdt een worker niet langer dan idleSeconds bezet
+                    const timeval limit{idleSeconds, 0};
+                    setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &limit, sizeof(limit));
+                    auto connection = std::make_unique<Connection>();
+                    connection->fd = client;
+                    connection->lastActive = Clock::now();
+                    connections.emplace(client, std::move(connection));
+                } else if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                    // De wachtende verbinding blijft staan, dus ppoll keert meteen terug: de listener
+                    // even niet bewaken tot er verbindingen sluiten in plaats van de cpu vol te draaien
+                    if (!starved) std::cerr << "Could not accept: " << std::strerror(errno) << ", retrying" << std::endl;
+                    starved = true;
+                    starvedUntil = Clock::now() + std::chrono::nanoseconds(acceptRetryNanoseconds);
+                } else if (errno != EINTR && errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNABORTED &&
+                           errno != EPROTO) {
+                    std::cerr << "Could not accept on " << socketPath << ": " << std::strerror(errno) << std::endl;
+                    status = 1;
+                    break;
+                }
+            }
+
+            // Stille verbindingen zonder lopend verzoek sluiten
+            const Clock::time_point after = Clock::now();
+            for (auto it = connections.begin(); it != connections.end();) {
+                if (!it->second->busy && after - it->second->lastActive >= idle) {
+                    it = closeConnection(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+
+        // Open verbindingen afbreken; lopende conversies worden nog afgewerkt
+        for (const auto &[fd, connection] : connections) shutdown(fd, SHUT_RDWR);
+        pool.wait();
+        for (const auto &[fd, connection] : connections) close(fd);
+    }
+
+    close(wakeFd);
+    wakeFd = -1;
+    finished.clear();
+    close(listener);
+    unlink(socketPath.c_str());
+    pthread_sigmask(SIG_SETMASK, &original, nullptr);
+    sigaction(SIGINT, &oldInt, nullptr);
+    sigaction(SIGTERM, &oldTerm, nullptr);
+    std::cout << "Stopped serving on " << socketPath << std::endl;
+    return status;
+}
@@ -0,0 +1,95 @@
+#ifndef CONVERSIONSERVER_H
+#define CONVERSIONSERVER_H
+
+#include "ConversionCache.h"
+#include "IncrementalCNF.h"
+#include <chrono>
+#include <cstddef>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// Langlopende conversieserver op een Unix domain socket (PDA2CFG --serve <socket>), zodat
+// tooling per conversie geen opstart, parser-opwarming en heap-groei betaalt.
+//
+// Protocol, meerdere verzoeken na elkaar per verbinding:
+//   verzoek:  <pda|cfg|add|remove> <bytes> [pruned] [cnf] [incremental] [format=text|json|jsonl|binary]\n
+//             gevolgd door <bytes> bytes
+//   antwoord: ok <bytes>\n<grammatica>   of   error <boodschap>\n
+// "pda" zet een PDA om naar een CFG (pruned: enkel bereikbare en productieve triples), "cfg"
+// leest een CFG; cnf zet het resultaat daarna om naar CNF. "pda ... cnf" vertrekt altijd van de
+// gesnoeide grammatica (zoals --cyk), dus pruned is enkel toegelaten bij "pda" zonder cnf; elders
+// is het een fout. Standaardformaat is json.
+//
+// "cfg ... incremental" maakt van de CFG de grammatica van de verbinding en geeft haar CNF.
+// "add" en "remove" wijzigen die grammatica met een productie per regel ("A -> a B", "A ->"
+// voor epsilon), bijgehouden met IncrementalCNF, en geven enkel het verschil in de CNF sinds
+// het vorige antwoord, als tekst ongeacht format: een regel "+ A -> B C" per toegevoegde en
+// "- A -> B C" per verwijderde productie, verwijderingen eerst. Een verzoek wordt helemaal of
+// niet toegepast; na een fout kan het volgende verschil ook hernoemde verse variabelen bevatten.
+//
+// De thread van run() accepteert en leest: hij wacht met ppoll op alle verbindingen zonder
+// lopend verzoek en geeft elk volledig ontvangen verzoek als een taak aan een vaste pool van
+// workers, die het omzet en het antwoord stuurt. Een trage conversie of client houdt zo enkel
+// zijn eigen verbinding op. Per verbinding loopt hoogstens een verzoek tegelijk, dus de
+// antwoorden komen in volgorde. Leesbuffers gaan na een verzoek terug naar een reserve voor
+// andere verbindingen, uitvoerbuffers zijn per worker; beide houden hun capaciteit, behalve
+// boven 1 MB: zo'n buffer wordt na het verzoek vrijgegeven. Een verbinding die idleSeconds
+// niets stuurt of niets leest wordt gesloten.
+class ConversionServer {
+public:
+    static constexpr std::size_t maxRequestBytes = std::size_t(256) << 20;
+    // Grens voor de triple-constructie, CNF-conversies en add/remove, kleiner dan de standaard van
+    // toCNF: een klein verzoek kan |Q|^2 |Γ| of exponentieel veel producties vragen en zo een
+    // worker lang bezet houden
+    static constexpr std::size_t maxProductions = std::size_t(1) << 20;
+    static constexpr int idleSeconds = 60;
+
+    // workers = 0: een worker per core. cache mag nullptr zijn.
+    ConversionServer(std::string socketPath, std::size_t workers, const ConversionCache *cache);
+
+    // Tot SIGINT/SIGTERM; 0 na een nette stop, 1 als de socket niet geopend kon worden of
+    // poll/accept blijvend faalt
+    int run();
+
+private:
+    struct Request {
+        std::string kind;
+        std::size_t bytes = 0;
+        bool pruned = false;
+        bool cnf = false;
+        bool incremental = false;
+        std::string format = "json";
+    };
+
+    // Enkel de thread van run() raakt een verbinding aan, behalve zolang busy: dan enkel de
+    // worker die het verzoek afhandelt
+    struct Connection {
+        int fd = -1;
+        std::string input;    // [0, filled) ontvangen; kan al het begin van een volgend verzoek bevatten
+        std::size_t filled = 0;
+        std::optional<Request> request;  // kopregel van het eerste verzoek in input, eenmaal gelezen
+        std::size_t bodyStart = 0;
+        std::optional<IncrementalCNF> session;  // grammatica van add/remove, enkel voor deze verbinding
+        bool busy = false;
+        std::chrono::steady_clock::time_point lastActive;
+    };
+
+    std::string socketPath;
+    std::size_t workers;
+    const ConversionCache *cache;
+
+    int wakeFd = -1;  // eventfd: een worker is klaar met een verzoek
+    std::mutex finishedMutex;
+    std::vector<std::pair<int, bool>> finished;  // (verbinding, openhouden) sinds de vorige ppoll
+
+    int listen();
+    void handle(Connection &connection);
+    void convert(const Request &request, std::string_view body, std::optional<IncrementalCNF> &session,
+                 std::string &payload) const;
+};
+
+#endif // CONVERSIONSERVER_H
@@ -0,0 +1,249 @@
+#include "Earley.h"
+#include "GrammarAnalysis.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    struct Entry {
+        std::uint32_t item;
+        std::uint32_t origin;
+    };
+
+    // Verzameling (item, origin)-paren van de huidige set: open adressering, gewist per set
+    // door een stempel op te hogen in plaats van de tabel te overschrijven.
+    class EntrySet {
+    public:
+        void clear() {
+            ++generation;
+            count = 0;
+        }
+
+        bool insert(std::uint32_t item, std::uint32_t origin) {
+            if ((count + 1) * 2 > keys.size()) grow();
+            const std::uint64_t key = std::uint64_t(item) << 32 | origin;
+            std::size_t mask = keys.size() - 1;
+            std::size_t slot = hash(key) & mask;
+            while (stamps[slot] == generation) {
+                if (keys[slot] == key) return false;
+                slot = (slot + 1) & mask;
+            }
+            stamps[slot] = generation;
+            keys[slot] = key;
+            ++count;
+            return true;
+        }
+
+    private:
+        std::vector<std::uint64_t> keys;
+        std::vector<std::uint32_t> stamps;
+        std::uint32_t generation = 1;
+        std::size_t count = 0;
+
+        static std::size_t hash(std::uint64_t key) {
+            key ^= key >> 33;
+            key *= 0xff51afd7ed558ccdULL;
+            key ^= key >> 33;
+            return static_cast<std::size_t>(key);
+        }
+
+        void grow() {
+            std::vector<std::uint64_t> oldKeys = std::move(keys);
+            std::vector<std::uint32_t> oldStamps = std::move(stamps);
+            keys.assign(std::max<std::size_t>(64, oldKeys.size() * 2), 0);
+            stamps.assign(keys.size(), 0);
+            std::size_t mask = keys.size() - 1;
+            for (std::size_t i = 0; i < oldKeys.size(); ++i) {
+                if (oldStamps[i] != generation) continue;
+                std::size_t slot = hash(oldKeys[i]) & mask;
+                while (stamps[slot] == generation) slot = (slot + 1) & mask;
+                stamps[slot] = generation;
+                keys[slot] = oldKeys[i];
+            }
+        }
+    };
+}
+
+Earley::Earley(const CFG &cfg) : Earley(cfg.toGrammar()) {}
+
+Earley::Earley(const Grammar &grammar) : acceptsEmpty(grammar.acceptsEmpty) {
+    std::vector<std::uint32_t> dense(grammar.symbolCount(), complete);
+    for (Grammar::Id id = 0; id < grammar.symbolCount(); ++id) {
+        if (grammar.isVariable(id)) dense[id] = static_cast<std::uint32_t>(variableCount++);
+    }
+
+    std::vector<char> nullableSymbols = computeNullable(grammar);
+    nullable.assign(variableCount, 0);
+    for (Grammar::Id id = 0; id < grammar.symbolCount(); ++id) {
+        if (grammar.isVariable(id)) nullable[dense[id]] = nullableSymbols[id];
+    }
+    const std::size_t productionCount = grammar.productionCount() + (grammar.startSymbol != SymbolTable::npos);
+    auto headOf = [&](std::size_t p) { return p < grammar.productionCount() ? dense[grammar.head(p)] : start; };
+
+    // Items per productie achter elkaar: punt 0 .. |body|
+    std::vector<std::uint32_t> firstItem(productionCount);
+    if (grammar.startSymbol != SymbolTable::npos) {
+        start = static_cast<std::uint32_t>(variableCount++);
+        nullable.push_back(0);
+        firstItem.back() = 0;
+        itemNext = {dense[grammar.startSymbol], complete};
+        itemHead = {start, start};
+    }
+    for (std::size_t p = 0; p < grammar.productionCount(); ++p) {
+        Grammar::Body body = grammar.body(p);
+        firstItem[p] = static_cast<std::uint32_t>(itemNext.size());
+        for (Grammar::Id symbol : body) {
+            if (grammar.isVariable(symbol)) {
+                itemNext.push_back(dense[symbol]);
+            } else {
+                std::string_view name = grammar.name(symbol);
+                itemNext.push_back(terminalFlag | (name.size() == 1 ? static_cast<unsigned char>(name[0]) : unmatched));
+            }
+        }
+        itemNext.push_back(complete);
+        itemHead.insert(itemHead.end(), body.size() + 1, dense[grammar.head(p)]);
+    }
+
+    // Startitems per variabele (counting sort op head)
+    firstOf.assign(variableCount + 1, 0);
+    for (std::size_t p = 0; p < productionCount; ++p) {
+        ++firstOf[headOf(p) + 1];
+    }
+    for (std::size_t v = 0; v < variableCount; ++v) {
+        firstOf[v + 1] += firstOf[v];
+    }
+    productionsOf.resize(productionCount);
+    std::vector<std::uint32_t> fill(firstOf.begin(), firstOf.end() - 1);
+    for (std::size_t p = 0; p < productionCount; ++p) {
+        productionsOf[fill[headOf(p)]++] = firstItem[p];
+    }
+}
+
+Earley::Run Earley::run(const std::string &input) const {
+    auto begin = std::chrono::steady_clock::now();
+    const std::size_t n = input.size();
+    bool accepted = n == 0 && acceptsEmpty;
+
+    if (start != complete) {
+        // Alle sets plat: set k = entries[setBegin[k], setBegin[k+1])
+        std::vector<Entry> entries;
+        std::vector<std::uint32_t> setBegin{0};
+        // Per afgesloten set: (wachtende variabele, entry) gesorteerd, voor de completer
+        std::vector<std::pair<std::uint32_t, std::uint32_t>> waiting;
+        std::vector<std::uint32_t> waitingBegin{0};
+        std::vector<std::uint32_t> predicted(variableCount, UINT32_MAX);  // set waarin B voorspeld werd
+        EntrySet seen;
+
+        auto add = [&](std::uint32_t item, std::uint32_t origin) {
+            if (seen.insert(item, origin)) entries.push_back({item, origin});
+        };
+        auto waitingFor = [&](std::uint32_t set, std::uint32_t variable) {
+            return std::equal_range(waiting.begin() + waitingBegin[set], waiting.begin() + waitingBegin[set + 1],
+                                    std::make_pair(variable, 0u),
+                                    [](const auto &a, const auto &b) { return a.first < b.first; });
+        };
+
+        // Leo-items, per wachtend item onthouden: het bovenste voltooide item van de keten die
+        // begint bij de enige B -> alpha . A in set j. De keten daalt strikt in set, dus geen
+        // cycli; ze wordt iteratief afgelopen omdat ze zo lang als de invoer kan zijn.
+        constexpr std::uint32_t unknown = complete - 1;
+        std::vector<Entry> leo;  // parallel aan waiting; item == complete: geen Leo-item
+        std::vector<std::uint32_t> path;
+        auto leoTop = [&](std::uint32_t set, std::uint32_t variable) {
+            Entry top{complete, 0};
+            path.clear();
+            while (true) {
+                auto range = waitingFor(set, variable);
+                if (range.second - range.first != 1) break;
+                const std::size_t slot = range.first - waiting.begin();
+                if (leo[slot].item != unknown) {
+                    top = leo[slot];
+                    break;
+                }
+                const Entry &parent = entries[range.first->second];
+                if (itemNext[parent.item + 1] != complete || parent.origin >= set) {
+                    leo[slot] = {complete, 0};
+                    break;
+                }
+                path.push_back(static_cast<std::uint32_t>(slot));
+                set = parent.origin;
+                variable = itemHead[parent.item];
+            }
+            for (auto it = path.rbegin(); it != path.rend(); ++it) {
+                const Entry &parent = entries[waiting[*it].second];
+                if (top.item == complete) top = {parent.item + 1, parent.origin};
+                leo[*it] = top;
+            }
+            return top;
+        };
+
+        seen.clear();
+        for (std::uint32_t i = firstOf[start]; i < firstOf[start + 1]; ++i) add(productionsOf[i], 0);
+        predicted[start] = 0;
+
+        for (std::size_t k = 0; k <= n; ++k) {
+            const std::uint32_t set = static_cast<std::uint32_t>(k);
+            for (std::size_t e = setBegin[k]; e < entries.size(); ++e) {
+                const Entry entry = entries[e];
+                const std::uint32_t next = itemNext[entry.item];
+                if (next == complete) {
+                    // Completer; origin == k komt niet voor dankzij de nullable-stap in de predictor
+                    if (entry.origin == set) continue;
+                    const std::uint32_t head = itemHead[entry.item];
+                    const Entry top = leoTop(entry.origin, head);
+                    if (top.item != complete) {
+                        add(top.item, top.origin);
+                        continue;
+                    }
+                    auto range = waitingFor(entry.origin, head);
+                    for (auto it = range.first; it != range.second; ++it) {
+                        const Entry &parent = entries[it->second];
+                        add(parent.item + 1, parent.origin);
+                    }
+                } else if (!(next & terminalFlag)) {
+                    // Predictor, een keer per variabele per set
+                    if (predicted[next] != set) {
+                        predicted[next] = set;
+                        for (std::uint32_t i = firstOf[next]; i < firstOf[next + 1]; ++i) add(productionsOf[i], set);
+                    }
+                    if (nullable[next]) add(entry.item + 1, entry.origin);
+                }
+            }
+
+            // Set k afsluiten: index van de wachtende items voor latere completions
+            const std::size_t waitingStart = waiting.size();
+            for (std::size_t e = setBegin[k]; e < entries.size(); ++e) {
+                const std::uint32_t next = itemNext[entries[e].item];
+                if (next != complete && !(next & terminalFlag)) {
+                    waiting.emplace_back(next, static_cast<std::uint32_t>(e));
+                }
+            }
+            std::sort(waiting.begin() + waitingStart, waiting.end());
+            leo.resize(waiting.size(), {unknown, 0});
+            waitingBegin.push_back(static_cast<std::uint32_t>(waiting.size()));
+
+            const std::size_t setEnd = entries.size();
+            if (k == n) {
+                for (std::size_t e = setBegin[k]; e < setEnd; ++e) {
+                    const Entry &entry = entries[e];
+                    if (entry.origin == 0 && itemNext[entry.item] == complete && itemHead[entry.item] == start) {
+                        accepted = true;
+                        break;
+                    }
+                }
+                break;
+            }
+
+            // Scanner naar set k + 1
+            setBegin.push_back(static_cast<std::uint32_t>(setEnd));
+            seen.clear();
+            const std::uint32_t token = terminalFlag | static_cast<unsigned char>(input[k]);
+            for (std::size_t e = setBegin[k]; e < setEnd; ++e) {
+                if (itemNext[entries[e].item] == token) add(entries[e].item + 1, entries[e].origin);
+            }
+            if (entries.size() == setEnd) break;  // geen enkel item kon het teken lezen
+        }
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return {accepted, elapsed.count()};
+}
@@ -0,0 +1,44 @@
+#ifndef EARLEY_H
+#define EARLEY_H
+
+#include "CFG.h"
+#include "Grammar.h"
+#include "Recognizer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Earley-herkenner op een willekeurige CFG, zonder CNF-conversie. Elk teken van de invoer is
+// een token (terminals met een naam van een teken; langere terminals matchen nooit).
+// Nullable variabelen volgens Aycock-Horspool: bij het voorspellen van een nullable B schuift
+// het item meteen over B, zodat completions binnen dezelfde set nooit nodig zijn.
+// Rechtse recursie via Leo: zolang een voltooide A in set j precies een wachtend item
+// B -> alpha . A heeft, wordt meteen het bovenste item van die keten toegevoegd in plaats van
+// elke tussenstap, zodat ook rechts-recursieve grammatica's lineair blijven.
+// Items (productie, punt) zijn dicht genummerd; alle Earley-sets staan plat in een array.
+class Earley {
+public:
+    using Run = RecognitionRun;
+
+    explicit Earley(const CFG &cfg);
+    explicit Earley(const Grammar &grammar);
+
+    bool accepts(const std::string &input) const { return run(input).accepted; }
+    Run run(const std::string &input) const;
+
+private:
+    static constexpr std::uint32_t complete = UINT32_MAX;     // punt aan het einde
+    static constexpr std::uint32_t terminalFlag = 1u << 31;   // next = terminalFlag | tekencode
+    static constexpr std::uint32_t unmatched = 256;           // terminal die nooit een teken is
+
+    bool acceptsEmpty = false;                 // Grammar::acceptsEmpty, bv. van een CNF uit --load-cnf
+    std::size_t variableCount = 0;
+    std::uint32_t start = complete;            // S' -> S, toegevoegd zodat S' nooit in een Leo-keten zit
+    std::vector<std::uint32_t> itemNext;       // per item: variabele, terminalFlag | code, of complete
+    std::vector<std::uint32_t> itemHead;       // per item: variabele van de productie
+    std::vector<std::uint32_t> productionsOf;  // variabele B = items productionsOf[firstOf[B], firstOf[B+1]) op punt 0
+    std::vector<std::uint32_t> firstOf;
+    std::vector<char> nullable;                // per variabele
+};
+
+#endif // EARLEY_H
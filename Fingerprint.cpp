@@ -0,0 +1,75 @@
+#include "Fingerprint.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+    std::uint64_t rotate(std::uint64_t x, int r) { return x << r | x >> (64 - r); }
+
+    // Finalizer van MurmurHash3: elk invoerbit beinvloedt elk uitvoerbit
+    std::uint64_t avalanche(std::uint64_t x) {
+        x ^= x >> 33;
+        x *= 0xff51afd7ed558ccdULL;
+        x ^= x >> 33;
+        x *= 0xc4ceb9fe1a85ec53ULL;
+        x ^= x >> 33;
+        return x;
+    }
+}
+
+std::string Fingerprint::hex() const {
+    static const char digits[] = "0123456789abcdef";
+    std::string text(32, '0');
+    for (int i = 0; i < 16; ++i) {
+        text[15 - i] = digits[high >> (4 * i) & 0xf];
+        text[31 - i] = digits[low >> (4 * i) & 0xf];
+    }
+    return text;
+}
+
+// Twee lanes met verschillende constanten, elk per 64-bit woord bijgewerkt
+void FingerprintBuilder::mix(std::uint64_t word) {
+    lanes[0] = rotate(lanes[0] ^ (word * 0x87c37b91114253d5ULL), 31) * 0x9e3779b97f4a7c15ULL;
+    lanes[1] = rotate(lanes[1] + (word ^ lanes[0]) * 0x4cf5ad432745937fULL, 27) * 0xc2b2ae3d27d4eb4fULL;
+    ++length;
+}
+
+FingerprintBuilder &FingerprintBuilder::add(std::string_view field) {
+    mix(field.size());
+    std::size_t at = 0;
+    for (; at + 8 <= field.size(); at += 8) {
+        std::uint64_t word;
+        std::memcpy(&word, field.data() + at, 8);
+        mix(word);
+    }
+    if (at < field.size()) {
+        std::uint64_t word = 0;
+        std::memcpy(&word, field.data() + at, field.size() - at);
+        mix(word);
+    }
+    return *this;
+}
+
+FingerprintBuilder &FingerprintBuilder::add(std::uint64_t value) {
+    mix(value);
+    return *this;
+}
+
+FingerprintBuilder &FingerprintBuilder::add(const Fingerprint &value) {
+    mix(value.high);
+    mix(value.low);
+    return *this;
+}
+
+FingerprintBuilder &FingerprintBuilder::addUnordered(std::vector<Fingerprint> elements) {
+    std::sort(elements.begin(), elements.end());
+    mix(elements.size());
+    for (const Fingerprint &element : elements) add(element);
+    return *this;
+}
+
+Fingerprint FingerprintBuilder::finish() const {
+    std::uint64_t a = lanes[0] ^ length, b = lanes[1] ^ length;
+    a += b;
+    b += a;
+    return {avalanche(a), avalanche(b ^ rotate(a, 17))};
+}
@@ -0,0 +1,44 @@
+#ifndef FINGERPRINT_H
+#define FINGERPRINT_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// 128-bit inhoudshash, bv. als sleutel van ConversionCache. Geen cryptografische hash:
+// bedoeld om identieke invoer terug te vinden, niet tegen opzettelijke botsingen.
+struct Fingerprint {
+    std::uint64_t high = 0;
+    std::uint64_t low = 0;
+
+    std::string hex() const;  // 32 hexadecimale tekens
+
+    bool operator==(const Fingerprint &other) const { return high == other.high && low == other.low; }
+    bool operator!=(const Fingerprint &other) const { return !(*this == other); }
+    bool operator<(const Fingerprint &other) const {
+        return high != other.high ? high < other.high : low < other.low;
+    }
+};
+
+// Bouwt een fingerprint op uit velden in volgorde. Elk veld krijgt zijn lengte mee, zodat
+// ("ab", "c") en ("a", "bc") verschillen. Voor verzamelingen: elk element apart hashen en
+// de hashes met addUnordered toevoegen; die worden eerst gesorteerd, dus de volgorde van de
+// elementen telt niet (dubbels wel, als multiset).
+class FingerprintBuilder {
+public:
+    FingerprintBuilder &add(std::string_view field);
+    FingerprintBuilder &add(std::uint64_t value);
+    FingerprintBuilder &add(const Fingerprint &value);
+    FingerprintBuilder &addUnordered(std::vector<Fingerprint> elements);
+
+    Fingerprint finish() const;
+
+private:
+    std::uint64_t lanes[2] = {0x243f6a8885a308d3ULL, 0x13198a2e03707344ULL};
+    std::uint64_t length = 0;
+
+    void mix(std::uint64_t word);
+};
+
+#endif // FINGERPRINT_H
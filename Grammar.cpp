@@ -0,0 +1,42 @@
+#include "Grammar.h"
+
+Grammar::Id Grammar::addSymbol(std::string_view name, bool isVar) {
+    Id id = symbols.intern(name);
+    if (id == variable.size()) {
+        variable.push_back(isVar ? 1 : 0);
+    } else if (isVar) {
+        variable[id] = 1;
+    }
+    return id;
+}
+
+Grammar::Id Grammar::addVariable(std::string_view name) {
+    return addSymbol(name, true);
+}
+
+Grammar::Id Grammar::addTerminal(std::string_view name) {
+    return addSymbol(name, false);
+}
+
+void Grammar::addProduction(Id head, const Id *body, std::size_t length) {
+    productions.add(head, body, length);
+}
+
+void Grammar::append(const ProductionBuffer &buffer) {
+    const std::uint32_t base = productions.offsets.back();
+    productions.heads.insert(productions.heads.end(), buffer.heads.begin(), buffer.heads.end());
+    productions.bodySymbols.insert(productions.bodySymbols.end(), buffer.bodySymbols.begin(), buffer.bodySymbols.end());
+    for (std::size_t p = 1; p < buffer.offsets.size(); ++p) {
+        productions.offsets.push_back(base + buffer.offsets[p]);
+    }
+}
+
+void Grammar::replaceProductions(ProductionBuffer buffer) {
+    productions = std::move(buffer);
+}
+
+void Grammar::reserve(std::size_t productionCount, std::size_t bodySymbolCount) {
+    productions.heads.reserve(productionCount);
+    productions.offsets.reserve(productionCount + 1);
+    productions.bodySymbols.reserve(bodySymbolCount);
+}
@@ -0,0 +1,79 @@
+#ifndef GRAMMAR_H
+#define GRAMMAR_H
+
+#include "SymbolTable.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Platte lijst producties zonder eigen symbooltabel: head-array + offsets in een body-array.
+// Kan los van een Grammar gevuld worden (bv. per thread) en er daarna aan toegevoegd worden.
+struct ProductionBuffer {
+    std::vector<SymbolTable::Id> heads;
+    std::vector<std::uint32_t> offsets{0};  // productie p = bodySymbols[offsets[p], offsets[p+1])
+    std::vector<SymbolTable::Id> bodySymbols;
+
+    void add(SymbolTable::Id head, const SymbolTable::Id *body, std::size_t length) {
+        heads.push_back(head);
+        bodySymbols.insert(bodySymbols.end(), body, body + length);
+        offsets.push_back(static_cast<std::uint32_t>(bodySymbols.size()));
+    }
+    void removeLast() {
+        heads.pop_back();
+        offsets.pop_back();
+        bodySymbols.resize(offsets.back());
+    }
+    std::size_t size() const { return heads.size(); }
+};
+
+// Compacte, geinterneerde vorm van een CFG: symbolen zijn ids uit een SymbolTable
+// en alle producties staan plat achter elkaar (head-array + offsets in een body-array).
+class Grammar {
+public:
+    using Id = SymbolTable::Id;
+
+    // Read-only zicht op de body van een productie
+    struct Body {
+        const Id *first;
+        const Id *last;
+
+        const Id *begin() const { return first; }
+        const Id *end() const { return last; }
+        std::size_t size() const { return static_cast<std::size_t>(last - first); }
+        bool empty() const { return first == last; }
+        Id operator[](std::size_t i) const { return first[i]; }
+    };
+
+    SymbolTable symbols;
+    Id startSymbol = SymbolTable::npos;
+    // De taal bevat ε ook al leidt geen productie het af: zo houdt de CNF (zonder ε-regels)
+    // bij dat het startsymbool voor de conversie nullable was
+    bool acceptsEmpty = false;
+
+    Id addVariable(std::string_view name);
+    Id addTerminal(std::string_view name);
+    bool isVariable(Id id) const { return variable[id] != 0; }
+
+    void addProduction(Id head, const Id *body, std::size_t length);
+    void addProduction(Id head, const std::vector<Id> &body) { addProduction(head, body.data(), body.size()); }
+    void append(const ProductionBuffer &buffer);  // ids moeten uit deze grammatica komen
+    void replaceProductions(ProductionBuffer buffer);  // idem; de symbolen blijven staan
+    void reserve(std::size_t productions, std::size_t bodySymbols);
+
+    std::size_t symbolCount() const { return symbols.size(); }
+    std::string_view name(Id id) const { return symbols.name(id); }
+    std::size_t productionCount() const { return productions.size(); }
+    Id head(std::size_t production) const { return productions.heads[production]; }
+    Body body(std::size_t production) const {
+        const Id *symbols = productions.bodySymbols.data();
+        return {symbols + productions.offsets[production], symbols + productions.offsets[production + 1]};
+    }
+
+private:
+    std::vector<std::uint8_t> variable;   // per symbool-id: 1 = variabele, 0 = terminal
+    ProductionBuffer productions;
+
+    Id addSymbol(std::string_view name, bool isVar);
+};
+
+#endif // GRAMMAR_H
@@ -0,0 +1,252 @@
+#include "GrammarAnalysis.h"
+#include <algorithm>
+
+OccurrenceIndex::OccurrenceIndex(const Grammar &grammar) : offsets(grammar.symbolCount() + 1, 0) {
+    const std::size_t productionCount = grammar.productionCount();
+    for (std::size_t p = 0; p < productionCount; ++p) {
+        for (Grammar::Id symbol : grammar.body(p)) {
+            ++offsets[symbol + 1];
+        }
+    }
+    for (std::size_t s = 1; s < offsets.size(); ++s) {
+        offsets[s] += offsets[s - 1];
+    }
+    productions.resize(offsets.back());
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t p = 0; p < productionCount; ++p) {
+        for (Grammar::Id symbol : grammar.body(p)) {
+            productions[fill[symbol]++] = static_cast<std::uint32_t>(p);
+        }
+    }
+}
+
+HeadIndex::HeadIndex(const Grammar &grammar) : offsets(grammar.symbolCount() + 1, 0) {
+    const std::size_t productionCount = grammar.productionCount();
+    for (std::size_t p = 0; p < productionCount; ++p) {
+        ++offsets[grammar.head(p) + 1];
+    }
+    for (std::size_t s = 1; s < offsets.size(); ++s) {
+        offsets[s] += offsets[s - 1];
+    }
+    productions.resize(productionCount);
+    std::vector<std::uint32_t> fill(offsets.begin(), offsets.end() - 1);
+    for (std::size_t p = 0; p < productionCount; ++p) {
+        productions[fill[grammar.head(p)]++] = static_cast<std::uint32_t>(p);
+    }
+}
+
+std::vector<char> computeNullable(const Grammar &grammar) {
+    return computeNullable(grammar, OccurrenceIndex(grammar));
+}
+
+std::vector<char> computeNullable(const Grammar &grammar, const OccurrenceIndex &occurrences) {
+    std::vector<char> nullable(grammar.symbolCount(), 0);
+    std::vector<std::uint32_t> remaining(grammar.productionCount());
+    std::vector<Grammar::Id> work;
+
+    auto mark = [&](Grammar::Id symbol) {
+        if (!nullable[symbol]) {
+            nullable[symbol] = 1;
+            work.push_back(symbol);
+        }
+    };
+
+    for (std::size_t p = 0; p < grammar.productionCount(); ++p) {
+        remaining[p] = static_cast<std::uint32_t>(grammar.body(p).size());
+        if (remaining[p] == 0) mark(grammar.head(p));
+    }
+
+    // Terminals worden nooit gemarkeerd, dus een body met een terminal bereikt nooit 0
+    while (!work.empty()) {
+        Grammar::Id symbol = work.back();
+        work.pop_back();
+        for (std::uint32_t i = occurrences.offsets[symbol]; i < occurrences.offsets[symbol + 1]; ++i) {
+            std::uint32_t p = occurrences.productions[i];
+            if (--remaining[p] == 0) mark(grammar.head(p));
+        }
+    }
+    return nullable;
+}
+
+std::vector<char> computeGenerating(const Grammar &grammar, const OccurrenceIndex &occurrences) {
+    std::vector<char> generating(grammar.symbolCount(), 0);
+    std::vector<std::uint32_t> remaining(grammar.productionCount(), 0);
+    std::vector<Grammar::Id> work;
+
+    auto mark = [&](Grammar::Id symbol) {
+        if (!generating[symbol]) {
+            generating[symbol] = 1;
+            work.push_back(symbol);
+        }
+    };
+
+    for (Grammar::Id id = 0; id < grammar.symbolCount(); ++id) {
+        if (!grammar.isVariable(id)) generating[id] = 1;
+    }
+    // Enkel variabelen tellen mee; terminals zijn van in het begin voldaan
+    for (std::size_t p = 0; p < grammar.productionCount(); ++p) {
+        for (Grammar::Id symbol : grammar.body(p)) {
+            if (grammar.isVariable(symbol)) ++remaining[p];
+        }
+    }
+    for (std::size_t p = 0; p < grammar.productionCount(); ++p) {
+        if (remaining[p] == 0) mark(grammar.head(p));
+    }
+
+    while (!work.empty()) {
+        Grammar::Id symbol = work.back();
+        work.pop_back();
+        for (std::uint32_t i = occurrences.offsets[symbol]; i < occurrences.offsets[symbol + 1]; ++i) {
+            std::uint32_t p = occurrences.productions[i];
+            if (--remaining[p] == 0) mark(grammar.head(p));
+        }
+    }
+    return generating;
+}
+
+Bitset computeReachable(const Grammar &grammar, const HeadIndex &heads, const std::vector<char> &generating) {
+    Bitset reachable(grammar.symbolCount());
+    if (grammar.startSymbol == SymbolTable::npos) return reachable;
+
+    std::vector<Grammar::Id> work{grammar.startSymbol};
+    reachable.set(grammar.startSymbol);
+    while (!work.empty()) {
+        Grammar::Id symbol = work.back();
+        work.pop_back();
+        for (std::uint32_t i = heads.offsets[symbol]; i < heads.offsets[symbol + 1]; ++i) {
+            Grammar::Body body = grammar.body(heads.productions[i]);
+            bool usable = true;
+            for (Grammar::Id s : body) {
+                if (!generating[s]) {
+                    usable = false;
+                    break;
+                }
+            }
+            if (!usable) continue;
+            for (Grammar::Id s : body) {
+                if (reachable.testAndSet(s)) work.push_back(s);
+            }
+        }
+    }
+    return reachable;
+}
+
+UnitClosure computeUnitClosure(const Grammar &grammar, const HeadIndex &heads) {
+    const std::size_t n = grammar.symbolCount();
+    UnitClosure closure;
+    closure.component.assign(n, UnitClosure::none);
+
+    auto unitTarget = [&](std::uint32_t production) {
+        Grammar::Body body = grammar.body(production);
+        return body.size() == 1 && grammar.isVariable(body[0]) ? body[0] : SymbolTable::npos;
+    };
+
+    // Iteratieve Tarjan; componenten worden genummerd in afwerkvolgorde (omgekeerd topologisch)
+    const std::uint32_t unvisited = UINT32_MAX;
+    std::vector<std::uint32_t> index(n, unvisited), low(n, 0);
+    std::vector<char> onStack(n, 0);
+    std::vector<Grammar::Id> stack, members;
+    std::vector<std::uint32_t> componentStart{0};
+    struct Frame {
+        Grammar::Id symbol;
+        std::uint32_t next;  // volgende positie in heads.productions
+    };
+    std::vector<Frame> frames;
+    std::uint32_t counter = 0;
+
+    auto visit = [&](Grammar::Id v) {
+        index[v] = low[v] = counter++;
+        stack.push_back(v);
+        onStack[v] = 1;
+        frames.push_back({v, heads.offsets[v]});
+    };
+
+    for (Grammar::Id root = 0; root < n; ++root) {
+        if (!grammar.isVariable(root) || index[root] != unvisited) continue;
+        visit(root);
+        while (!frames.empty()) {
+            Frame &frame = frames.back();
+            Grammar::Id v = frame.symbol;
+            Grammar::Id w = SymbolTable::npos;
+            while (frame.next < heads.offsets[v + 1] && w == SymbolTable::npos) {
+                w = unitTarget(heads.productions[frame.next++]);
+            }
+            if (w != SymbolTable::npos) {
+                ++closure.directUnitCount;
+                if (index[w] == unvisited) {
+                    visit(w);
+                } else if (onStack[w]) {
+                    low[v] = std::min(low[v], index[w]);
+                }
+                continue;
+            }
+
+            if (low[v] == index[v]) {
+                const std::uint32_t id = static_cast<std::uint32_t>(componentStart.size() - 1);
+                Grammar::Id member;
+                do {
+                    member = stack.back();
+                    stack.pop_back();
+                    onStack[member] = 0;
+                    closure.component[member] = id;
+                    members.push_back(member);
+                } while (member != v);
+                componentStart.push_back(static_cast<std::uint32_t>(members.size()));
+            }
+            frames.pop_back();
+            if (!frames.empty()) {
+                Grammar::Id parent = frames.back().symbol;
+                low[parent] = std::min(low[parent], low[v]);
+            }
+        }
+    }
+
+    // Dichte index over de symbolen die in een unit-productie voorkomen (bron of doel)
+    std::vector<std::uint32_t> dense(n, UnitClosure::none);
+    const std::size_t componentCount = componentStart.size() - 1;
+    std::vector<char> hasExit(componentCount, 0);
+    for (Grammar::Id v = 0; v < n; ++v) {
+        if (!grammar.isVariable(v)) continue;
+        for (std::uint32_t i = heads.offsets[v]; i < heads.offsets[v + 1]; ++i) {
+            Grammar::Id w = unitTarget(heads.productions[i]);
+            if (w == SymbolTable::npos) continue;
+            dense[v] = dense[w] = 0;
+            if (closure.component[w] != closure.component[v]) hasExit[closure.component[v]] = 1;
+        }
+    }
+    for (Grammar::Id v = 0; v < n; ++v) {
+        if (dense[v] == UnitClosure::none) continue;
+        dense[v] = static_cast<std::uint32_t>(closure.unitSymbols.size());
+        closure.unitSymbols.push_back(v);
+    }
+
+    // Rijen in afwerkvolgorde: opvolgende componenten zijn dan al volledig. Een enkele variabele
+    // zonder unit-producties naar een andere component sluit enkel zichzelf en krijgt geen rij.
+    closure.rowOf.assign(componentCount, UnitClosure::none);
+    std::vector<std::uint32_t> lastMerged(componentCount, UnitClosure::none);
+    for (std::uint32_t c = 0; c < componentCount; ++c) {
+        if (!hasExit[c] && componentStart[c + 1] - componentStart[c] == 1) continue;
+        Bitset row(closure.unitSymbols.size());
+        for (std::uint32_t m = componentStart[c]; m < componentStart[c + 1]; ++m) {
+            row.set(dense[members[m]]);
+        }
+        for (std::uint32_t m = componentStart[c]; m < componentStart[c + 1]; ++m) {
+            Grammar::Id v = members[m];
+            for (std::uint32_t i = heads.offsets[v]; i < heads.offsets[v + 1]; ++i) {
+                Grammar::Id w = unitTarget(heads.productions[i]);
+                if (w == SymbolTable::npos) continue;
+                std::uint32_t target = closure.component[w];
+                if (target == c || lastMerged[target] == c) continue;
+                lastMerged[target] = c;
+                if (closure.rowOf[target] == UnitClosure::none) {
+                    row.set(dense[w]);
+                } else {
+                    row |= closure.rows[closure.rowOf[target]];
+                }
+            }
+        }
+        closure.rowOf[c] = static_cast<std::uint32_t>(closure.rows.size());
+        closure.rows.push_back(std::move(row));
+    }
+    return closure;
+}
@@ -0,0 +1,67 @@
+#ifndef GRAMMARANALYSIS_H
+#define GRAMMARANALYSIS_H
+
+#include "Bitset.h"
+#include "Grammar.h"
+#include <cstdint>
+#include <vector>
+
+// Analyses op de geinterneerde grammatica. Resultaten zijn geindexeerd op symbool-id.
+
+// Omgekeerde voorkomenslijsten: voor elk symbool de producties waarin het in de body staat
+// (een productie komt meerdere keren voor als het symbool meermaals in de body staat).
+struct OccurrenceIndex {
+    std::vector<std::uint32_t> offsets;      // symbool s = productions[offsets[s], offsets[s+1])
+    std::vector<std::uint32_t> productions;
+
+    explicit OccurrenceIndex(const Grammar &grammar);
+};
+
+// Producties gegroepeerd per head (counting sort op head-id).
+struct HeadIndex {
+    std::vector<std::uint32_t> offsets;      // head h = productions[offsets[h], offsets[h+1])
+    std::vector<std::uint32_t> productions;
+
+    explicit HeadIndex(const Grammar &grammar);
+};
+
+// Nullable variabelen in lineaire tijd: per productie een teller van nog niet nullable symbolen.
+std::vector<char> computeNullable(const Grammar &grammar);
+std::vector<char> computeNullable(const Grammar &grammar, const OccurrenceIndex &occurrences);
+
+// Genererende symbolen (Horn-SAT): terminals zijn genererend, een variabele zodra een van
+// haar producties geen niet-genererende variabelen meer bevat.
+std::vector<char> computeGenerating(const Grammar &grammar, const OccurrenceIndex &occurrences);
+
+// Bereikbare symbolen vanuit het startsymbool, enkel via producties die volledig genererend zijn.
+Bitset computeReachable(const Grammar &grammar, const HeadIndex &heads, const std::vector<char> &generating);
+
+// Transitieve sluiting van de unit-relatie A =>* B (enkel via producties A -> B).
+// De unit-graaf wordt gecondenseerd tot sterk samenhangende componenten. Enkel componenten met
+// meer dan een lid of een unit-productie naar een andere component krijgen een bitset-rij: de OR
+// van hun eigen leden en de rijen van hun opvolgers. De rijen zijn dicht geindexeerd over de symbolen die in een
+// unit-productie voorkomen, niet over alle symbolen; een variabele zonder rij sluit enkel zichzelf.
+struct UnitClosure {
+    static constexpr std::uint32_t none = UINT32_MAX;
+
+    std::vector<std::uint32_t> component;    // per symbool-id, none voor terminals
+    std::vector<std::uint32_t> rowOf;        // per component: index in rows, of none
+    std::vector<Bitset> rows;
+    std::vector<Grammar::Id> unitSymbols;    // bit i van een rij = unitSymbols[i], stijgend
+    std::size_t directUnitCount = 0;         // aantal unit-producties A -> B
+
+    // Roept f(B) op voor elke B met variable =>* B (inclusief variable zelf), in stijgende volgorde
+    template <typename F>
+    void forEach(Grammar::Id variable, F f) const {
+        const std::uint32_t row = rowOf[component[variable]];
+        if (row == none) {
+            f(variable);
+            return;
+        }
+        rows[row].forEach([&](std::size_t i) { f(unitSymbols[i]); });
+    }
+};
+
+UnitClosure computeUnitClosure(const Grammar &grammar, const HeadIndex &heads);
+
+#endif // GRAMMARANALYSIS_H
@@ -0,0 +1,281 @@
+#include "GrammarBinary.h"
+#include <algorithm>
+#include <cstring>
+#include <fcntl.h>
+#include <iostream>
+#include <unordered_set>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+    const char magic[8] = {'P', 'D', 'A', '2', 'C', 'F', 'G', '\0'};
+    const std::uint32_t version = 3;
+    const std::uint32_t byteOrder = 0x01020304;
+    const std::uint32_t acceptsEmptyFlag = 1;
+
+    struct Header {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t byteOrder;
+        std::uint64_t symbolCount;
+        std::uint64_t productionCount;
+        std::uint64_t nameBytes;
+        std::uint64_t bodySymbolCount;
+        std::uint32_t startSymbol;
+        std::uint32_t flags;     // bit 0: Grammar::acceptsEmpty, andere bits 0
+        std::uint32_t checksum;  // over het hele bestand met dit veld op 0, zie Checksum
+        std::uint32_t reserved;  // 0
+    };
+    static_assert(sizeof(Header) % 8 == 0, "sections start on 8-byte boundaries");
+
+    std::size_t padded(std::size_t bytes) { return (bytes + 7) & ~std::size_t(7); }
+
+    // Checksum over de 64-bit woorden van het bestand, met het checksumveld zelf op 0. De header
+    // en alle secties zijn opgevuld tot 8 bytes, dus dat zijn precies de woorden van het bestand
+    // (little-endian, zoals het formaat zelf).
+    class Checksum {
+    public:
+        void add(std::uint64_t word) {
+            hash = (hash ^ word) * 0x9e3779b97f4a7c15ULL;
+            hash = hash << 31 | hash >> 33;
+        }
+        std::uint32_t finish() const { return static_cast<std::uint32_t>(hash ^ hash >> 32); }
+
+        // Zelfde interface als OutputSink, zodat writeSections er ook naar kan schrijven
+        void put(char c) {
+            pending |= static_cast<std::uint64_t>(static_cast<unsigned char>(c)) << (8 * filled);
+            if (++filled == 8) {
+                add(pending);
+                pending = 0;
+                filled = 0;
+            }
+        }
+        void write(std::string_view bytes) {
+            for (char c : bytes) put(c);
+        }
+
+    private:
+        std::uint64_t hash = 0x6a09e667f3bcc908ULL;
+        std::uint64_t pending = 0;
+        unsigned filled = 0;
+    };
+
+    template <typename Out, typename T>
+    void writeValue(Out &out, const T &value) {
+        out.write(std::string_view(reinterpret_cast<const char *>(&value), sizeof(T)));
+    }
+
+    template <typename Out>
+    void writePadding(Out &out, std::size_t bytes) {
+        for (std::size_t i = bytes; i < padded(bytes); ++i) out.put('\0');
+    }
+
+    // Alles na de header; een keer naar Checksum en een keer naar het bestand
+    template <typename Out>
+    void writeSections(const Grammar &grammar, const Header &header, Out &out) {
+        const std::size_t symbolCount = grammar.symbolCount();
+        const std::size_t productionCount = grammar.productionCount();
+
+        std::uint32_t offset = 0;
+        writeValue(out, offset);
+        for (Grammar::Id id = 0; id < symbolCount; ++id) {
+            offset += static_cast<std::uint32_t>(grammar.symbols.name(id).size());
+            writeValue(out, offset);
+        }
+        writePadding(out, (symbolCount + 1) * sizeof(std::uint32_t));
+
+        for (Grammar::Id id = 0; id < symbolCount; ++id) {
+            out.write(grammar.symbols.name(id));
+        }
+        writePadding(out, header.nameBytes);
+
+        for (Grammar::Id id = 0; id < symbolCount; ++id) {
+            out.put(grammar.isVariable(id) ? 1 : 0);
+        }
+        writePadding(out, symbolCount);
+
+        for (std::size_t p = 0; p < productionCount; ++p) {
+            writeValue(out, grammar.head(p));
+        }
+        writePadding(out, productionCount * sizeof(Grammar::Id));
+
+        offset = 0;
+        writeValue(out, offset);
+        for (std::size_t p = 0; p < productionCount; ++p) {
+            offset += static_cast<std::uint32_t>(grammar.body(p).size());
+            writeValue(out, offset);
+        }
+        writePadding(out, (productionCount + 1) * sizeof(std::uint32_t));
+
+        for (std::size_t p = 0; p < productionCount; ++p) {
+            for (Grammar::Id symbol : grammar.body(p)) {
+                writeValue(out, symbol);
+            }
+        }
+        writePadding(out, header.bodySymbolCount * sizeof(Grammar::Id));
+    }
+}
+
+void writeGrammarBinary(const Grammar &grammar, OutputSink &out) {
+    Header header{};
+    std::memcpy(header.magic, magic, sizeof(magic));
+    header.version = version;
+    header.byteOrder = byteOrder;
+    header.symbolCount = grammar.symbolCount();
+    header.productionCount = grammar.productionCount();
+    for (Grammar::Id id = 0; id < grammar.symbolCount(); ++id) {
+        header.nameBytes += grammar.symbols.name(id).size();
+    }
+    for (std::size_t p = 0; p < grammar.productionCount(); ++p) {
+        header.bodySymbolCount += grammar.body(p).size();
+    }
+    header.startSymbol = grammar.startSymbol;
+    header.flags = grammar.acceptsEmpty ? acceptsEmptyFlag : 0;
+    Checksum checksum;
+    writeValue(checksum, header);
+    writeSections(grammar, header, checksum);
+    header.checksum = checksum.finish();
+
+    writeValue(out, header);
+    writeSections(grammar, header, out);
+    out.flush();
+}
+
+bool isGrammarBinary(std::istream &input) {
+    const std::streampos position = input.tellg();
+    char start[sizeof(magic)] = {};
+    input.read(start, sizeof(start));
+    const bool matches = input.gcount() == sizeof(start) && std::memcmp(start, magic, sizeof(magic)) == 0;
+    input.clear();
+    input.seekg(position);
+    return matches;
+}
+
+MappedGrammar::MappedGrammar(const std::string &filename) {
+    std::string error = map(filename);
+    if (!error.empty()) {
+        std::cerr << error << std::endl;
+        exit(1);
+    }
+}
+
+std::unique_ptr<MappedGrammar> MappedGrammar::tryOpen(const std::string &filename, bool trusted) {
+    std::unique_ptr<MappedGrammar> grammar(new MappedGrammar());
+    if (!grammar->map(filename, trusted).empty()) return nullptr;
+    return grammar;
+}
+
+std::string MappedGrammar::map(const std::string &filename, bool trusted) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    struct stat info{};
+    if (fd < 0 || fstat(fd, &info) != 0) {
+        if (fd >= 0) close(fd);
+        return "Could not open file " + filename;
+    }
+    length = static_cast<std::size_t>(info.st_size);
+    if (length >= sizeof(Header)) {
+        data = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) data = nullptr;
+    }
+    close(fd);
+
+    const Header *header = static_cast<const Header *>(data);
+    if (!header || std::memcmp(header->magic, magic, sizeof(magic)) != 0 || header->version != version ||
+        header->byteOrder != byteOrder) {
+        return "Not a binary grammar (version " + std::to_string(version) + "): " + filename;
+    }
+
+    // Elke teller past in het bestand en in de uint32-velden: zo loopt geen sectiegrootte over
+    const std::uint64_t limit = std::min<std::uint64_t>(length, SymbolTable::npos);
+    if (header->symbolCount >= limit || header->productionCount >= limit || header->nameBytes > limit ||
+        header->bodySymbolCount > limit / sizeof(Id)) {
+        return "Corrupt binary grammar (counts): " + filename;
+    }
+    symbols = header->symbolCount;
+    productions = header->productionCount;
+    startSymbol = header->startSymbol;
+    acceptsEmpty = (header->flags & acceptsEmptyFlag) != 0;
+
+    // Secties na elkaar, elk uitgelijnd op 8 bytes
+    const char *base = static_cast<const char *>(data);
+    std::size_t at = sizeof(Header);
+    auto section = [&](std::size_t bytes) {
+        const char *start = base + at;
+        at += padded(bytes);
+        return start;
+    };
+    nameOffsets = reinterpret_cast<const std::uint32_t *>(section((symbols + 1) * sizeof(std::uint32_t)));
+    names = section(header->nameBytes);
+    variable = reinterpret_cast<const std::uint8_t *>(section(symbols));
+    heads = reinterpret_cast<const Id *>(section(productions * sizeof(Id)));
+    offsets = reinterpret_cast<const std::uint32_t *>(section((productions + 1) * sizeof(std::uint32_t)));
+    bodySymbols = reinterpret_cast<const Id *>(section(header->bodySymbolCount * sizeof(Id)));
+    if (at > length) return "Truncated binary grammar: " + filename;
+    if ((header->flags & ~acceptsEmptyFlag) != 0 || header->reserved != 0) {
+        return "Corrupt binary grammar (flags): " + filename;
+    }
+    if (startSymbol != SymbolTable::npos && startSymbol >= symbols) return "Corrupt binary grammar (start): " + filename;
+    // Bij het schrijven al volledig gecontroleerd (ConversionCache::store): enkel header en
+    // sectiegrenzen, zodat openen niet van de grootte van het bestand afhangt
+    if (trusted) return "";
+
+    // Elke sectie begint op een veelvoud van 8 in een mmap op een paginagrens
+    Header copy = *header;
+    copy.checksum = 0;
+    Checksum checksum;
+    writeValue(checksum, copy);
+    for (std::size_t word = sizeof(Header); word < at; word += sizeof(std::uint64_t)) {
+        std::uint64_t value;
+        std::memcpy(&value, base + word, sizeof(value));
+        checksum.add(value);
+    }
+    if (checksum.finish() != header->checksum) return "Corrupt binary grammar (checksum): " + filename;
+    return validate(header->nameBytes, header->bodySymbolCount) ? "" : "Corrupt binary grammar: " + filename;
+}
+
+bool MappedGrammar::validate(std::size_t nameBytes, std::size_t bodySymbolCount) const {
+    // Offsets beginnen bij 0, dalen nooit en eindigen op de lengte van hun sectie
+    if (nameOffsets[0] != 0 || nameOffsets[symbols] != nameBytes) return false;
+    for (std::size_t id = 0; id < symbols; ++id) {
+        if (nameOffsets[id] > nameOffsets[id + 1]) return false;
+    }
+    if (offsets[0] != 0 || offsets[productions] != bodySymbolCount) return false;
+    for (std::size_t p = 0; p < productions; ++p) {
+        if (offsets[p] > offsets[p + 1] || heads[p] >= symbols || !variable[heads[p]]) return false;
+    }
+    for (std::size_t i = 0; i < bodySymbolCount; ++i) {
+        if (bodySymbols[i] >= symbols) return false;
+    }
+
+    // Dubbele namen zouden in toGrammar een id delen en de verwijzingen verschuiven
+    std::unordered_set<std::string_view> seen;
+    seen.reserve(symbols);
+    for (Id id = 0; id < symbols; ++id) {
+        if (!seen.insert(name(id)).second) return false;
+    }
+    return true;
+}
+
+MappedGrammar::~MappedGrammar() {
+    if (data) munmap(data, length);
+}
+
+Grammar MappedGrammar::toGrammar() const {
+    Grammar grammar;
+    for (Id id = 0; id < symbols; ++id) {
+        if (isVariable(id)) {
+            grammar.addVariable(name(id));
+        } else {
+            grammar.addTerminal(name(id));
+        }
+    }
+    grammar.startSymbol = startSymbol;
+    grammar.acceptsEmpty = acceptsEmpty;
+    grammar.reserve(productions, offsets[productions]);
+    for (std::size_t p = 0; p < productions; ++p) {
+        Grammar::Body b = body(p);
+        grammar.addProduction(heads[p], b.begin(), b.size());
+    }
+    return grammar;
+}
@@ -0,0 +1,71 @@
+#ifndef GRAMMARBINARY_H
+#define GRAMMARBINARY_H
+
+#include "Grammar.h"
+#include "OutputSink.h"
+#include <cstdint>
+#include <istream>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Binair grammaticaformaat (versie 3, little-endian), elke sectie uitgelijnd op 8 bytes:
+//   header (magic "PDA2CFG\0", versie, byte-order merker, tellers, startsymbool, vlaggen, checksum)
+//   uint32 nameOffsets[symbols + 1], char names[], uint8 variable[symbols],
+//   uint32 heads[productions], uint32 offsets[productions + 1], uint32 bodySymbols[]
+// Het bestand is rechtstreeks de geheugenlayout van Grammar, zodat MappedGrammar het via
+// mmap kan gebruiken zonder te parsen of te kopieren.
+
+void writeGrammarBinary(const Grammar &grammar, OutputSink &out);
+// Begint de stroom met de magic van dit formaat? De leespositie blijft waar ze was.
+bool isGrammarBinary(std::istream &input);
+
+class MappedGrammar {
+public:
+    using Id = Grammar::Id;
+
+    explicit MappedGrammar(const std::string &filename);  // stopt het programma bij een fout
+    ~MappedGrammar();
+
+    // Zonder te stoppen: nullptr als het bestand ontbreekt of geen geldige grammatica is. Checksum,
+    // tellers, offsets, ids en namen worden gecontroleerd. Met trusted enkel de header en of de
+    // secties in het bestand passen: voor bestanden die bij het schrijven al volledig gecontroleerd
+    // zijn en daarna niet meer veranderen (ConversionCache), zodat een treffer geen lineaire pass is.
+    static std::unique_ptr<MappedGrammar> tryOpen(const std::string &filename, bool trusted = false);
+
+    MappedGrammar(const MappedGrammar &) = delete;
+    MappedGrammar &operator=(const MappedGrammar &) = delete;
+
+    Id startSymbol = SymbolTable::npos;
+    bool acceptsEmpty = false;  // zie Grammar::acceptsEmpty
+
+    std::size_t symbolCount() const { return symbols; }
+    std::size_t productionCount() const { return productions; }
+    std::string_view name(Id id) const { return {names + nameOffsets[id], nameOffsets[id + 1] - nameOffsets[id]}; }
+    bool isVariable(Id id) const { return variable[id] != 0; }
+    Id head(std::size_t production) const { return heads[production]; }
+    Grammar::Body body(std::size_t production) const {
+        return {bodySymbols + offsets[production], bodySymbols + offsets[production + 1]};
+    }
+
+    Grammar toGrammar() const;  // Kopie in geheugen, bv. om verder te bewerken
+
+private:
+    MappedGrammar() = default;
+    std::string map(const std::string &filename, bool trusted = false);  // foutmelding, leeg bij succes
+    // Na map: offsets, ids, koppen en dubbele namen
+    bool validate(std::size_t nameBytes, std::size_t bodySymbolCount) const;
+
+    void *data = nullptr;
+    std::size_t length = 0;
+    std::size_t symbols = 0;
+    std::size_t productions = 0;
+    const std::uint32_t *nameOffsets = nullptr;
+    const char *names = nullptr;
+    const std::uint8_t *variable = nullptr;
+    const Id *heads = nullptr;
+    const std::uint32_t *offsets = nullptr;
+    const Id *bodySymbols = nullptr;
+};
+
+#endif // GRAMMARBINARY_H
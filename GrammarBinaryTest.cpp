@@ -0,0 +1,183 @@
+// Test van het binaire grammaticaformaat: een grammatica moet ongewijzigd terugkomen uit
+// MappedGrammar, en een bestand met een omgedraaide bit, een afgekapt bestand of een
+// beschadigde offset met een kloppende checksum moet geweigerd worden door tryOpen. De trusted
+// weg (ConversionCache::find) kijkt enkel naar de header en de sectiegrenzen: die weigert een
+// vreemde magic, versie of vlag en een afgekapt bestand, maar leest de secties zelf niet.
+//
+//   ./PDA2CFG_binary_test
+#include "GrammarBinary.h"
+#include <algorithm>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <unistd.h>
+
+namespace {
+    int failures = 0;
+
+    void fail(const std::string &message) {
+        std::cerr << "FAIL: " << message << std::endl;
+        ++failures;
+    }
+
+    using Bytes = std::string;
+
+    const std::filesystem::path file =
+            std::filesystem::temp_directory_path() / ("pda2cfg_binary_test_" + std::to_string(getpid()) + ".bin");
+
+    void save(const Bytes &bytes) {
+        std::ofstream out(file, std::ios::binary | std::ios::trunc);
+        out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    }
+
+    Bytes load() {
+        std::ifstream in(file, std::ios::binary);
+        return Bytes(std::istreambuf_iterator<char>(in), {});
+    }
+
+    // Velden van de header (zie GrammarBinary.cpp): tellers vanaf byte 16, checksum op 56
+    std::uint64_t field64(const Bytes &bytes, std::size_t at) {
+        std::uint64_t value;
+        std::memcpy(&value, bytes.data() + at, sizeof(value));
+        return value;
+    }
+
+    void setField32(Bytes &bytes, std::size_t at, std::uint32_t value) {
+        std::memcpy(&bytes[at], &value, sizeof(value));
+    }
+
+    // Zelfde checksum als GrammarBinary.cpp, om een bestand te maken dat enkel validate() kan weigeren
+    void fixChecksum(Bytes &bytes) {
+        setField32(bytes, 56, 0);
+        std::uint64_t hash = 0x6a09e667f3bcc908ULL;
+        for (std::size_t at = 0; at < bytes.size(); at += 8) {
+            hash = (hash ^ field64(bytes, at)) * 0x9e3779b97f4a7c15ULL;
+            hash = hash << 31 | hash >> 33;
+        }
+        setField32(bytes, 56, static_cast<std::uint32_t>(hash ^ hash >> 32));
+    }
+
+    std::size_t padded(std::size_t bytes) { return (bytes + 7) & ~std::size_t(7); }
+
+    Grammar sample() {
+        Grammar grammar;
+        const Grammar::Id S = grammar.addVariable("S"), A = grammar.addVariable("A"), B = grammar.addVariable("[p,Z0,q]");
+        const Grammar::Id a = grammar.addTerminal("a"), b = grammar.addTerminal("b");
+        grammar.startSymbol = S;
+        grammar.acceptsEmpty = true;
+        grammar.addProduction(S, {A, B});
+        grammar.addProduction(A, {a});
+        grammar.addProduction(B, {b});
+        grammar.addProduction(B, {B, A});
+        return grammar;
+    }
+
+    bool same(const Grammar &expected, const MappedGrammar &actual) {
+        if (expected.symbolCount() != actual.symbolCount() || expected.productionCount() != actual.productionCount() ||
+            expected.startSymbol != actual.startSymbol || expected.acceptsEmpty != actual.acceptsEmpty) {
+            return false;
+        }
+        for (Grammar::Id id = 0; id < expected.symbolCount(); ++id) {
+            if (expected.name(id) != actual.name(id) || expected.isVariable(id) != actual.isVariable(id)) return false;
+        }
+        for (std::size_t p = 0; p < expected.productionCount(); ++p) {
+            Grammar::Body x = expected.body(p), y = actual.body(p);
+            if (expected.head(p) != actual.head(p) || x.size() != y.size() ||
+                !std::equal(x.begin(), x.end(), y.begin())) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void expectRejected(const Bytes &bytes, const std::string &label, bool trustedToo) {
+        save(bytes);
+        if (MappedGrammar::tryOpen(file.string())) fail(label + ": accepted");
+        if (trustedToo && MappedGrammar::tryOpen(file.string(), true)) fail(label + ": accepted as trusted");
+    }
+}
+
+int main() {
+    const Grammar grammar = sample();
+    {
+        OutputSink out(file.string());
+        writeGrammarBinary(grammar, out);
+        if (!out.close()) fail("could not write " + file.string());
+    }
+    const Bytes original = load();
+
+    auto mapped = MappedGrammar::tryOpen(file.string());
+    if (!mapped || !same(grammar, *mapped)) fail("round trip changed the grammar");
+    if (mapped) {
+        // En via toGrammar terug naar hetzelfde bestand
+        Bytes again;
+        {
+            OutputSink out(&again);
+            writeGrammarBinary(mapped->toGrammar(), out);
+        }
+        if (again != original) fail("writing toGrammar() gives different bytes");
+    }
+    mapped.reset();
+
+    // Elke omgedraaide bit valt op in de header, de checksum of validate(); in magic, versie en
+    // byte-order merker (de eerste 16 bytes) ook zonder checksum
+    for (std::size_t at = 0; at < original.size(); ++at) {
+        for (int bit = 0; bit < 8; ++bit) {
+            Bytes bytes = original;
+            bytes[at] ^= static_cast<char>(1 << bit);
+            expectRejected(bytes, "bit " + std::to_string(bit) + " of byte " + std::to_string(at), at < 16);
+        }
+    }
+    {
+        // Trusted rekent de checksum niet na: een treffer kost geen pass over het bestand
+        Bytes bytes = original;
+        bytes[56] ^= 1;
+        save(bytes);
+        if (!MappedGrammar::tryOpen(file.string(), true)) fail("trusted open verifies the checksum");
+    }
+    for (std::size_t length = 0; length < original.size(); ++length) {
+        expectRejected(original.substr(0, length), "truncated to " + std::to_string(length) + " bytes", true);
+    }
+
+    // Beschadigingen met een kloppende checksum: enkel validate() houdt ze tegen
+    Bytes unchanged = original;
+    fixChecksum(unchanged);
+    if (unchanged != original) fail("the test's checksum differs from the format's");
+    const std::size_t symbols = field64(original, 16), productions = field64(original, 24);
+    const std::size_t nameBytes = field64(original, 32);
+    const std::size_t nameOffsets = 64;
+    const std::size_t heads = nameOffsets + padded((symbols + 1) * 4) + padded(nameBytes) + padded(symbols);
+    const std::size_t offsets = heads + padded(productions * 4);
+    const std::size_t bodySymbols = offsets + padded((productions + 1) * 4);
+    auto corrupt = [&](std::size_t at, std::uint32_t value, const std::string &label, bool trustedToo = false) {
+        Bytes bytes = original;
+        setField32(bytes, at, value);
+        fixChecksum(bytes);
+        expectRejected(bytes, label, trustedToo);
+    };
+    corrupt(nameOffsets + 4, 1000, "name offset past the names");
+    corrupt(heads, static_cast<std::uint32_t>(symbols), "head id out of range");
+    corrupt(heads, static_cast<std::uint32_t>(symbols) - 1, "terminal as head");
+    corrupt(offsets + 4, 1000, "body offset past the bodies");
+    corrupt(bodySymbols, 0xfffffff0u, "body symbol id out of range");
+    corrupt(48, static_cast<std::uint32_t>(symbols) + 3, "start symbol out of range", true);
+    corrupt(52, 2, "unknown flag", true);
+
+    // Twee keer dezelfde naam: enkel de volledige controle ziet het
+    {
+        Bytes bytes = original;
+        const std::size_t names = nameOffsets + padded((symbols + 1) * 4);
+        bytes[names + 1] = 'S';  // "A" wordt "S"
+        fixChecksum(bytes);
+        expectRejected(bytes, "duplicate name", false);
+    }
+
+    std::filesystem::remove(file);
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "binary grammar round trip and rejection checks passed" << std::endl;
+    return 0;
+}
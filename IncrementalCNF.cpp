@@ -0,0 +1,879 @@
+#include "IncrementalCNF.h"
+#include <algorithm>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+namespace {
+    using Id = SymbolTable::Id;
+
+    // Horn-afsluiting over een RuleSet: value[h] wordt 1 zodra een regel van h enkel symbolen
+    // met value 1 bevat (nullable: terminals 0, genererend: terminals 1).
+    template <typename Rules>
+    bool satisfied(const Rules &rules, const std::vector<char> &value, Id rule) {
+        for (Id symbol : rules[rule].body) {
+            if (!value[symbol]) return false;
+        }
+        return true;
+    }
+
+    // Propageert vanaf de symbolen in work; nieuw gezette symbolen komen in gained
+    template <typename Rules>
+    void propagate(const Rules &rules, std::vector<char> &value, std::vector<Id> work, std::vector<Id> &gained) {
+        while (!work.empty()) {
+            Id symbol = work.back();
+            work.pop_back();
+            for (Id rule : rules.occurrences(symbol)) {
+                Id head = rules[rule].head;
+                if (!value[head] && satisfied(rules, value, rule)) {
+                    value[head] = 1;
+                    gained.push_back(head);
+                    work.push_back(head);
+                }
+            }
+        }
+    }
+
+    template <typename Rules>
+    void mark(const Rules &rules, std::vector<char> &value, Id head, std::vector<Id> &gained) {
+        if (value[head]) return;
+        value[head] = 1;
+        gained.push_back(head);
+        propagate(rules, value, {head}, gained);
+    }
+
+    // head verloor (mogelijk) zijn steun: alles wat er via voldane regels van afhangt wissen,
+    // daarna opnieuw afleiden wat nog steun heeft. Geeft de symbolen terug die echt 0 werden.
+    template <typename Rules>
+    std::vector<Id> retract(const Rules &rules, std::vector<char> &value, Id head) {
+        std::vector<Id> candidates{head};
+        std::unordered_set<Id> seen{head};
+        for (std::size_t i = 0; i < candidates.size(); ++i) {
+            for (Id rule : rules.occurrences(candidates[i])) {
+                Id h = rules[rule].head;
+                if (value[h] && !seen.count(h) && satisfied(rules, value, rule)) {
+                    seen.insert(h);
+                    candidates.push_back(h);
+                }
+            }
+        }
+        for (Id symbol : candidates) value[symbol] = 0;
+
+        std::vector<Id> regained;
+        for (Id symbol : candidates) {
+            if (value[symbol]) continue;
+            for (Id rule : rules.byHead(symbol)) {
+                if (satisfied(rules, value, rule)) {
+                    mark(rules, value, symbol, regained);
+                    break;
+                }
+            }
+        }
+
+        std::vector<Id> lost;
+        for (Id symbol : candidates) {
+            if (!value[symbol]) lost.push_back(symbol);
+        }
+        return lost;
+    }
+
+    template <typename F>
+    void forEachToken(std::string_view body, F f) {
+        std::size_t pos = 0;
+        while (pos < body.size()) {
+            std::size_t end = body.find(' ', pos);
+            if (end == std::string_view::npos) end = body.size();
+            if (end > pos) f(body.substr(pos, end - pos));
+            pos = end + 1;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// RuleSet
+
+std::size_t IncrementalCNF::RuleSet::KeyHash::operator()(const std::vector<Id> &key) const {
+    std::size_t hash = key.size();
+    for (Id id : key) {
+        hash ^= id + 0x9e3779b97f4a7c15ULL + (hash << 6) + (hash >> 2);
+    }
+    return hash;
+}
+
+std::vector<IncrementalCNF::Id> IncrementalCNF::RuleSet::key(Id head, const std::vector<Id> &body) {
+    std::vector<Id> result;
+    result.reserve(body.size() + 1);
+    result.push_back(head);
+    result.insert(result.end(), body.begin(), body.end());
+    return result;
+}
+
+void IncrementalCNF::RuleSet::resize(std::size_t symbols) {
+    if (heads.size() < symbols) {
+        heads.resize(symbols);
+        uses.resize(symbols);
+    }
+}
+
+std::pair<IncrementalCNF::Id, bool> IncrementalCNF::RuleSet::acquire(Id head, const std::vector<Id> &body) {
+    auto [it, inserted] = index.emplace(key(head, body), 0);
+    if (!inserted) {
+        ++refs[it->second];
+        return {it->second, false};
+    }
+
+    Id rule;
+    if (!freeSlots.empty()) {
+        rule = freeSlots.back();
+        freeSlots.pop_back();
+        rules[rule] = {head, body};
+        refs[rule] = 1;
+    } else {
+        rule = static_cast<Id>(rules.size());
+        rules.push_back({head, body});
+        refs.push_back(1);
+    }
+    it->second = rule;
+    ++liveCount;
+
+    heads[head].push_back(rule);
+    for (std::size_t i = 0; i < body.size(); ++i) {
+        if (std::find(body.begin(), body.begin() + i, body[i]) == body.begin() + i) {
+            uses[body[i]].push_back(rule);
+        }
+    }
+    return {rule, true};
+}
+
+bool IncrementalCNF::RuleSet::release(Id rule) {
+    if (--refs[rule] > 0) return false;
+
+    auto unlink = [rule](std::vector<Id> &list) {
+        auto it = std::find(list.begin(), list.end(), rule);
+        *it = list.back();
+        list.pop_back();
+    };
+    const Rule &r = rules[rule];
+    unlink(heads[r.head]);
+    for (std::size_t i = 0; i < r.body.size(); ++i) {
+        if (std::find(r.body.begin(), r.body.begin() + i, r.body[i]) == r.body.begin() + i) {
+            unlink(uses[r.body[i]]);
+        }
+    }
+    index.erase(key(r.head, r.body));
+    freeSlots.push_back(rule);
+    --liveCount;
+    return true;
+}
+
+IncrementalCNF::Id IncrementalCNF::RuleSet::find(Id head, const std::vector<Id> &body) const {
+    auto it = index.find(key(head, body));
+    return it == index.end() ? SymbolTable::npos : it->second;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Symbolen
+
+IncrementalCNF::IncrementalCNF(const CFG &cfg, std::size_t productionLimit) : productionLimit(productionLimit) {
+    bool kindChanged = false;
+    for (std::string_view nt : cfg.nonTerminals()) {
+        symbol(nt, true, kindChanged);
+    }
+    for (char terminal : cfg.terminals) {
+        symbol(std::string(1, terminal), false, kindChanged);
+    }
+    setStartSymbol(cfg.startSymbol);
+    cfg.forEachProduction([this](std::string_view head, std::string_view body) { addProduction(head, body); });
+}
+
+IncrementalCNF::Id IncrementalCNF::symbol(std::string_view name, bool head, bool &kindChanged) {
+    Id id = symbols.intern(name);
+    if (id == variable.size()) {
+        // Een verse variabele met dezelfde naam moet wijken: haar regels krijgen een andere
+        Id output = names.intern(name);
+        if (output == roles.size()) {
+            roles.push_back(Role::Free);
+            owners.push_back(SymbolTable::npos);
+            sourceOf.push_back(SymbolTable::npos);
+            cnf.resize(names.size());
+        }
+        if (roles[output] == Role::Chain || roles[output] == Role::Terminal) rename(output);
+        roles[output] = Role::Source;
+        sourceOf[output] = id;
+        nameOf.push_back(output);
+
+        variable.push_back(head ? 1 : 0);
+        grow();
+    } else if (head && !variable[id]) {
+        // Een terminal die een head wordt: alle lagen moeten herrekend worden
+        variable[id] = 1;
+        kindChanged = true;
+    }
+    return id;
+}
+
+std::vector<IncrementalCNF::Id> IncrementalCNF::tokens(std::string_view body, bool &kindChanged) {
+    std::vector<Id> result;
+    forEachToken(body, [&](std::string_view token) { result.push_back(symbol(token, false, kindChanged)); });
+    return result;
+}
+
+void IncrementalCNF::grow() {
+    const std::size_t n = variable.size();
+    const Id id = static_cast<Id>(n - 1);
+    source.resize(n);
+    expanded.resize(n);
+    unitFree.resize(n);
+    nullable.resize(n, 0);
+    generating.resize(n, variable[id] ? 0 : 1);
+    reachable.resize(n, 0);
+    closure.resize(n);
+    coclosure.resize(n);
+    if (variable[id]) {
+        closure[id].insert(id);
+        coclosure[id].insert(id);
+    }
+    terminalVar.resize(n, SymbolTable::npos);
+    terminalUsers.resize(n, 0);
+    spareChain.resize(n);
+    chainCount.resize(n, 1);
+}
+
+std::vector<std::pair<IncrementalCNF::Id, std::vector<IncrementalCNF::Id>>> IncrementalCNF::sourceRules() const {
+    std::vector<std::pair<Id, std::vector<Id>>> rules;
+    for (Id rule = 0; rule < source.slots(); ++rule) {
+        if (source.live(rule)) rules.emplace_back(source[rule].head, source[rule].body);
+    }
+    return rules;
+}
+
+void IncrementalCNF::rebuild(const std::vector<std::pair<Id, std::vector<Id>>> &rules) {
+    // Eerst de uitvoer van de oude regels weg, zolang hun inhoud nog leesbaar is
+    for (Id rule = 0; rule < emitted.size(); ++rule) {
+        if (!emitted[rule].empty()) retire(rule);
+    }
+    emitted.clear();
+    dirtyRules.clear();
+    dirtyAll = true;
+
+    const std::size_t n = variable.size();
+    source = RuleSet();
+    expanded = RuleSet();
+    unitFree = RuleSet();
+    source.resize(n);
+    expanded.resize(n);
+    unitFree.resize(n);
+    variants.clear();
+    nullable.assign(n, 0);
+    generating.assign(n, 0);
+    reachable.assign(n, 0);
+    closure.assign(n, {});
+    coclosure.assign(n, {});
+    for (Id id = 0; id < n; ++id) {
+        if (variable[id]) {
+            closure[id].insert(id);
+            coclosure[id].insert(id);
+        } else {
+            generating[id] = 1;
+        }
+    }
+    if (start != SymbolTable::npos) reachable[start] = 1;
+
+    for (const auto &[head, body] : rules) {
+        addSource(head, body);
+    }
+}
+
+void IncrementalCNF::setStartSymbol(std::string_view name) {
+    editing([&] {
+        bool kindChanged = false;
+        Id id = symbol(name, true, kindChanged);
+        if (id == start && !kindChanged) return;
+        start = id;
+        if (kindChanged) {
+            // Een variabele zonder regels is niet nullable: de varianten blijven binnen de grens
+            rebuild(sourceRules());
+            return;
+        }
+        std::fill(reachable.begin(), reachable.end(), 0);
+        reachable[start] = 1;
+        markReachable({start});
+        dirtyAll = true;
+    });
+}
+
+bool IncrementalCNF::isNullable(std::string_view name) const {
+    Id id = symbols.find(name);
+    return id != SymbolTable::npos && nullable[id];
+}
+
+bool IncrementalCNF::isUseful(std::string_view name) const {
+    Id id = symbols.find(name);
+    return id != SymbolTable::npos && generating[id] && reachable[id];
+}
+
+// ---------------------------------------------------------------------------------------------
+// Bron en epsilon-eliminatie
+
+bool IncrementalCNF::addProduction(std::string_view headName, std::string_view bodyText) {
+    bool added = false;
+    editing([&] {
+        bool kindChanged = false;
+        Id head = symbol(headName, true, kindChanged);
+        std::vector<Id> body = tokens(bodyText, kindChanged);
+        if (source.find(head, body) != SymbolTable::npos) return;
+
+        if (kindChanged) {
+            std::vector<std::pair<Id, std::vector<Id>>> rules = sourceRules();
+            rules.emplace_back(head, body);
+            try {
+                rebuild(rules);
+            } catch (const std::length_error &) {
+                // Terug naar de vorige toestand, die binnen de grens bleef
+                rules.pop_back();
+                variable[head] = 0;
+                rebuild(rules);
+                throw;
+            }
+        } else {
+            addSource(head, body);
+        }
+        added = true;
+    });
+    return added;
+}
+
+void IncrementalCNF::addSource(Id head, const std::vector<Id> &body) {
+    Id rule = source.acquire(head, body).first;
+    if (variants.size() < source.slots()) variants.resize(source.slots());
+
+    std::vector<Id> gained;
+    if (satisfied(source, nullable, rule)) mark(source, nullable, head, gained);
+
+    // Bronregels waarin een nieuw nullable symbool staat krijgen extra varianten
+    std::set<Id> affected{rule};
+    for (Id symbol : gained) {
+        affected.insert(source.occurrences(symbol).begin(), source.occurrences(symbol).end());
+    }
+
+    // Eerst controleren, dan pas uitbreiden: zo is terugdraaien enkel nullable en de bronregel.
+    // Ook 1 << 64 zelf zou al ongedefinieerd zijn; ver daarvoor is het geheugen op.
+    for (Id r : affected) {
+        std::size_t occurrences = 0;
+        for (Id symbol : source[r].body) occurrences += nullable[symbol];
+        if (occurrences >= 64 || std::uint64_t(1) << occurrences > productionLimit) {
+            const std::string name(symbols.name(source[r].head));
+            for (Id symbol : gained) nullable[symbol] = 0;
+            source.release(rule);
+            throw std::length_error("epsilon elimination: a production of " + name + " has " +
+                                    std::to_string(occurrences) + " nullable occurrences, more variants than the limit of " +
+                                    std::to_string(productionLimit) + " productions");
+        }
+    }
+    for (Id r : affected) {
+        expand(r);
+    }
+
+    if (expanded.size() > productionLimit || unitFree.size() > productionLimit) {
+        const char *pass = expanded.size() > productionLimit ? "epsilon" : "unit";
+        removeSource(rule);
+        throw std::length_error(std::string(pass) + " elimination: more than " + std::to_string(productionLimit) +
+                                " productions");
+    }
+}
+
+bool IncrementalCNF::removeProduction(std::string_view headName, std::string_view bodyText) {
+    Id head = symbols.find(headName);
+    if (head == SymbolTable::npos) return false;
+    std::vector<Id> body;
+    bool known = true;
+    forEachToken(bodyText, [&](std::string_view token) {
+        Id id = symbols.find(token);
+        known = known && id != SymbolTable::npos;
+        body.push_back(id);
+    });
+    Id rule = known ? source.find(head, body) : SymbolTable::npos;
+    if (rule == SymbolTable::npos) return false;
+    editing([&] { removeSource(rule); });
+    return true;
+}
+
+void IncrementalCNF::removeSource(Id rule) {
+    const Id head = source[rule].head;
+    const bool supported = nullable[head] && satisfied(source, nullable, rule);
+    std::vector<Id> old = std::move(variants[rule]);
+    variants[rule].clear();
+    source.release(rule);
+    for (Id variant : old) {
+        releaseExpanded(variant);
+    }
+
+    // Symbolen die niet langer nullable zijn: hun bronregels verliezen varianten
+    if (supported) {
+        std::set<Id> affected;
+        for (Id symbol : retract(source, nullable, head)) {
+            affected.insert(source.occurrences(symbol).begin(), source.occurrences(symbol).end());
+        }
+        for (Id r : affected) {
+            expand(r);
+        }
+    }
+}
+
+void IncrementalCNF::expand(Id rule) {
+    // Elke deelverzameling van nullable voorkomens weglaten; enkel niet-lege, unieke varianten
+    const std::vector<Id> &body = source[rule].body;
+    const Id head = source[rule].head;
+    std::vector<std::size_t> positions;
+    for (std::size_t i = 0; i < body.size(); ++i) {
+        if (nullable[body[i]]) positions.push_back(i);
+    }
+
+    std::set<std::vector<Id>> bodies;
+    const std::uint64_t count = std::uint64_t(1) << positions.size();
+    for (std::uint64_t mask = 0; mask < count; ++mask) {
+        std::vector<Id> variant;
+        std::size_t k = 0;
+        for (std::size_t i = 0; i < body.size(); ++i) {
+            if (k < positions.size() && positions[k] == i) {
+                if (mask >> k++ & 1) continue;
+            }
+            variant.push_back(body[i]);
+        }
+        if (!variant.empty()) bodies.insert(std::move(variant));
+    }
+
+    // Eerst de nieuwe varianten nemen, dan de oude loslaten: gedeelde varianten vallen zo nooit weg
+    std::vector<Id> fresh;
+    for (const auto &variant : bodies) {
+        auto [e, created] = expanded.acquire(head, variant);
+        fresh.push_back(e);
+        if (!created) continue;
+        const auto &added = expanded[e];
+        if (isUnit(added.body)) {
+            if (added.body[0] != head) addUnitEdge(head, added.body[0]);
+        } else {
+            std::vector<Id> heads(coclosure[head].begin(), coclosure[head].end());
+            for (Id x : heads) acquireUnitFree(x, variant);
+        }
+    }
+    std::vector<Id> old = std::move(variants[rule]);
+    variants[rule] = std::move(fresh);
+    for (Id e : old) {
+        releaseExpanded(e);
+    }
+}
+
+void IncrementalCNF::releaseExpanded(Id rule) {
+    const Id head = expanded[rule].head;
+    const std::vector<Id> body = expanded[rule].body;
+    if (!expanded.release(rule)) return;
+    if (isUnit(body)) {
+        if (body[0] != head) removeUnitEdge(head);
+    } else {
+        std::vector<Id> heads(coclosure[head].begin(), coclosure[head].end());
+        for (Id x : heads) releaseUnitFree(x, body);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Unit-sluiting
+
+void IncrementalCNF::addUnitEdge(Id from, Id to) {
+    // Nieuwe paren zijn precies coclosure(from) x closure(to)
+    std::vector<Id> sources(coclosure[from].begin(), coclosure[from].end());
+    std::vector<Id> targets(closure[to].begin(), closure[to].end());
+    for (Id x : sources) {
+        for (Id y : targets) {
+            if (!closure[x].insert(y).second) continue;
+            coclosure[y].insert(x);
+            for (Id e : expanded.byHead(y)) {
+                if (!isUnit(expanded[e].body)) acquireUnitFree(x, expanded[e].body);
+            }
+        }
+    }
+}
+
+void IncrementalCNF::removeUnitEdge(Id from) {
+    // Enkel variabelen die from bereikten kunnen iets verliezen; hun sluiting opnieuw opbouwen
+    std::vector<Id> sources(coclosure[from].begin(), coclosure[from].end());
+    for (Id x : sources) {
+        std::unordered_set<Id> next{x};
+        std::vector<Id> work{x};
+        while (!work.empty()) {
+            Id y = work.back();
+            work.pop_back();
+            for (Id e : expanded.byHead(y)) {
+                const auto &body = expanded[e].body;
+                if (isUnit(body) && next.insert(body[0]).second) work.push_back(body[0]);
+            }
+        }
+
+        std::vector<Id> lost;
+        for (Id y : closure[x]) {
+            if (!next.count(y)) lost.push_back(y);
+        }
+        closure[x] = std::move(next);
+        for (Id y : lost) {
+            coclosure[y].erase(x);
+            std::vector<Id> rules(expanded.byHead(y));
+            for (Id e : rules) {
+                if (!isUnit(expanded[e].body)) releaseUnitFree(x, expanded[e].body);
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------
+// Genererend en bereikbaar
+
+bool IncrementalCNF::enabled(const RuleSet::Rule &rule) const {
+    for (Id symbol : rule.body) {
+        if (!generating[symbol]) return false;
+    }
+    return true;
+}
+
+void IncrementalCNF::markReachable(std::vector<Id> work) {
+    while (!work.empty()) {
+        Id symbol = work.back();
+        work.pop_back();
+        for (Id rule : unitFree.byHead(symbol)) {
+            if (!enabled(unitFree[rule])) continue;
+            for (Id s : unitFree[rule].body) {
+                if (!reachable[s]) {
+                    reachable[s] = 1;
+                    dirtyHeads.push_back(s);
+                    work.push_back(s);
+                }
+            }
+        }
+    }
+}
+
+void IncrementalCNF::retractReachable(std::vector<Id> seeds) {
+    // Kandidaten: alles wat vanaf de zaden via ingeschakelde regels bereikt wordt
+    std::vector<Id> candidates;
+    std::unordered_set<Id> seen;
+    for (Id symbol : seeds) {
+        if (reachable[symbol] && symbol != start && seen.insert(symbol).second) candidates.push_back(symbol);
+    }
+    for (std::size_t i = 0; i < candidates.size(); ++i) {
+        for (Id rule : unitFree.byHead(candidates[i])) {
+            if (!enabled(unitFree[rule])) continue;
+            for (Id s : unitFree[rule].body) {
+                if (reachable[s] && s != start && seen.insert(s).second) candidates.push_back(s);
+            }
+        }
+    }
+    for (Id symbol : candidates) reachable[symbol] = 0;
+
+    for (Id symbol : candidates) {
+        if (reachable[symbol]) continue;
+        for (Id rule : unitFree.occurrences(symbol)) {
+            if (reachable[unitFree[rule].head] && enabled(unitFree[rule])) {
+                reachable[symbol] = 1;
+                markReachable({symbol});
+                break;
+            }
+        }
+    }
+    for (Id symbol : candidates) {
+        if (!reachable[symbol]) dirtyHeads.push_back(symbol);
+    }
+}
+
+void IncrementalCNF::acquireUnitFree(Id head, const std::vector<Id> &body) {
+    auto [rule, created] = unitFree.acquire(head, body);
+    if (!created) return;
+    if (emitted.size() < unitFree.slots()) emitted.resize(unitFree.slots());
+    dirtyRules.push_back(rule);
+
+    std::vector<Id> gained;
+    if (satisfied(unitFree, generating, rule)) mark(unitFree, generating, head, gained);
+    dirtyHeads.insert(dirtyHeads.end(), gained.begin(), gained.end());
+    dirtyBodies.insert(dirtyBodies.end(), gained.begin(), gained.end());
+
+    // Regels die nu volledig genererend zijn openen nieuwe paden vanaf bereikbare heads
+    std::vector<Id> work;
+    auto open = [&](Id r) {
+        if (!reachable[unitFree[r].head] || !enabled(unitFree[r])) return;
+        for (Id s : unitFree[r].body) {
+            if (!reachable[s]) {
+                reachable[s] = 1;
+                dirtyHeads.push_back(s);
+                work.push_back(s);
+            }
+        }
+    };
+    open(rule);
+    for (Id symbol : gained) {
+        for (Id r : unitFree.occurrences(symbol)) open(r);
+    }
+    markReachable(std::move(work));
+}
+
+void IncrementalCNF::releaseUnitFree(Id head, const std::vector<Id> &body) {
+    Id rule = unitFree.find(head, body);
+    if (!unitFree.release(rule)) return;
+    // Nu, voor het vak hergebruikt kan worden
+    if (!emitted[rule].empty()) retire(rule);
+
+    bool wasEnabled = true;
+    for (Id symbol : body) {
+        wasEnabled = wasEnabled && generating[symbol];
+    }
+    std::vector<Id> seeds;
+    if (wasEnabled && reachable[head]) seeds = body;
+    if (wasEnabled && generating[head]) {
+        // Regels met een symbool dat niet meer genererend is vallen weg uit de bereikbaarheid
+        for (Id symbol : retract(unitFree, generating, head)) {
+            dirtyHeads.push_back(symbol);
+            dirtyBodies.push_back(symbol);
+            for (Id r : unitFree.occurrences(symbol)) {
+                seeds.insert(seeds.end(), unitFree[r].body.begin(), unitFree[r].body.end());
+            }
+        }
+    }
+    if (!seeds.empty()) retractReachable(std::move(seeds));
+}
+
+// ---------------------------------------------------------------------------------------------
+// Uitvoer: de CNF-regels per actieve regel van unitFree
+
+template <typename F>
+void IncrementalCNF::editing(F change) {
+    // Ook een mislukte wijziging kan regels hebben laten vallen: de uitvoer volgt altijd
+    try {
+        change();
+    } catch (...) {
+        sync();
+        throw;
+    }
+    sync();
+}
+
+bool IncrementalCNF::available(const std::string &name) const {
+    if (symbols.find(name) != SymbolTable::npos) return false;
+    Id id = names.find(name);
+    return id == SymbolTable::npos || roles[id] == Role::Free;
+}
+
+IncrementalCNF::Id IncrementalCNF::freshName(const std::string &name, Role role, Id owner) {
+    Id id = names.intern(name);
+    if (id == roles.size()) {
+        roles.push_back(Role::Free);
+        owners.push_back(SymbolTable::npos);
+        sourceOf.push_back(SymbolTable::npos);
+        cnf.resize(names.size());
+    }
+    roles[id] = role;
+    owners[id] = owner;
+    return id;
+}
+
+IncrementalCNF::Id IncrementalCNF::chainVariable(Id head, Id owner) {
+    // Eerst een vrijgekomen naam van dezelfde head, tenzij die intussen elders in gebruik is
+    auto &spare = spareChain[head];
+    while (!spare.empty()) {
+        Id id = spare.back();
+        spare.pop_back();
+        if (roles[id] == Role::Free) {
+            roles[id] = Role::Chain;
+            owners[id] = owner;
+            return id;
+        }
+    }
+    std::string name;
+    do {
+        name = std::string(symbols.name(head)) + "_" + std::to_string(++chainCount[head]);
+    } while (!available(name));
+    return freshName(name, Role::Chain, owner);
+}
+
+void IncrementalCNF::emitRule(Id head, const std::vector<Id> &body, std::vector<Id> &rules) {
+    rules.push_back(cnf.acquire(head, body).first);
+    std::vector<Id> key{head};
+    key.insert(key.end(), body.begin(), body.end());
+    auto it = changes.emplace(std::move(key), 0).first;
+    if (++it->second == 0) changes.erase(it);
+}
+
+void IncrementalCNF::releaseRule(Id rule) {
+    const auto &r = cnf[rule];
+    std::vector<Id> key{r.head};
+    key.insert(key.end(), r.body.begin(), r.body.end());
+    cnf.release(rule);
+    auto it = changes.emplace(std::move(key), 0).first;
+    if (--it->second == 0) changes.erase(it);
+}
+
+void IncrementalCNF::emit(Id rule) {
+    const auto &r = unitFree[rule];
+
+    // Terminals in bodies van lengte >= 2 vervangen door "_t", gedeeld door alle gebruikers
+    std::vector<Id> body;
+    body.reserve(r.body.size());
+    for (Id symbol : r.body) {
+        if (r.body.size() < 2 || variable[symbol]) {
+            body.push_back(nameOf[symbol]);
+            continue;
+        }
+        if (terminalUsers[symbol]++ == 0) {
+            std::string name = "_" + std::string(symbols.name(symbol));
+            while (!available(name)) name.insert(0, 1, '_');
+            terminalVar[symbol] = freshName(name, Role::Terminal, symbol);
+            std::vector<Id> shared;
+            emitRule(terminalVar[symbol], {nameOf[symbol]}, shared);
+        }
+        body.push_back(terminalVar[symbol]);
+    }
+
+    // Lange bodies opsplitsen in een keten A -> X A_2, A_2 -> Y A_3, ...
+    std::vector<Id> &rules = emitted[rule];
+    Id head = nameOf[r.head];
+    for (std::size_t i = 0; i + 2 < body.size(); ++i) {
+        Id next = chainVariable(r.head, rule);
+        emitRule(head, {body[i], next}, rules);
+        head = next;
+    }
+    const std::size_t tail = body.size() > 2 ? body.size() - 2 : 0;
+    emitRule(head, std::vector<Id>(body.begin() + tail, body.end()), rules);
+}
+
+void IncrementalCNF::retire(Id rule) {
+    const auto &r = unitFree[rule];
+    std::vector<Id> rules = std::move(emitted[rule]);
+    emitted[rule].clear();
+
+    // De body zoals uitgegeven; variable[] kan intussen veranderd zijn (rebuild)
+    std::vector<Id> body;
+    for (std::size_t i = 0; i < rules.size(); ++i) {
+        const auto &out = cnf[rules[i]];
+        if (i + 1 < rules.size()) {
+            body.push_back(out.body[0]);
+        } else {
+            body.insert(body.end(), out.body.begin(), out.body.end());
+        }
+        if (i > 0) roles[out.head] = Role::Free;
+        releaseRule(rules[i]);
+    }
+    // Omgekeerd, zodat een nieuwe keten voor deze head dezelfde namen in dezelfde volgorde krijgt
+    for (std::size_t i = rules.size(); i-- > 1;) spareChain[r.head].push_back(cnf[rules[i]].head);
+    for (std::size_t i = 0; i < body.size(); ++i) {
+        Id symbol = r.body[i];
+        if (body[i] != terminalVar[symbol] || --terminalUsers[symbol] > 0) continue;
+        Id var = terminalVar[symbol];
+        releaseRule(cnf.find(var, {nameOf[symbol]}));
+        roles[var] = Role::Free;
+        terminalVar[symbol] = SymbolTable::npos;
+    }
+}
+
+void IncrementalCNF::rename(Id id) {
+    // De naam gaat naar een bronsymbool: de regels die de verse variabele gebruiken opnieuw uitgeven
+    if (roles[id] == Role::Chain) {
+        Id rule = owners[id];
+        retire(rule);
+        dirtyRules.push_back(rule);
+        return;
+    }
+    const Id terminal = owners[id];
+    const std::vector<Id> users = unitFree.occurrences(terminal);
+    for (Id rule : users) {
+        if (unitFree[rule].body.size() >= 2 && !emitted[rule].empty()) {
+            retire(rule);
+            dirtyRules.push_back(rule);
+        }
+    }
+}
+
+void IncrementalCNF::sync() {
+    if (dirtyAll) {
+        dirtyRules.clear();
+        for (Id rule = 0; rule < unitFree.slots(); ++rule) dirtyRules.push_back(rule);
+    } else {
+        for (Id symbol : dirtyHeads) {
+            dirtyRules.insert(dirtyRules.end(), unitFree.byHead(symbol).begin(), unitFree.byHead(symbol).end());
+        }
+        for (Id symbol : dirtyBodies) {
+            const auto &users = unitFree.occurrences(symbol);
+            dirtyRules.insert(dirtyRules.end(), users.begin(), users.end());
+        }
+    }
+    std::sort(dirtyRules.begin(), dirtyRules.end());
+    dirtyRules.erase(std::unique(dirtyRules.begin(), dirtyRules.end()), dirtyRules.end());
+
+    // Eerst uit, dan aan: vrijgekomen namen zijn zo meteen herbruikbaar
+    std::vector<Id> on;
+    for (Id rule : dirtyRules) {
+        if (!unitFree.live(rule)) continue;
+        const auto &r = unitFree[rule];
+        const bool active = generating[r.head] && reachable[r.head] && enabled(r);
+        if (active && emitted[rule].empty()) {
+            on.push_back(rule);
+        } else if (!active && !emitted[rule].empty()) {
+            retire(rule);
+        }
+    }
+    for (Id rule : on) emit(rule);
+
+    dirtyHeads.clear();
+    dirtyBodies.clear();
+    dirtyRules.clear();
+    dirtyAll = false;
+}
+
+std::vector<IncrementalCNF::Change> IncrementalCNF::takeChanges() {
+    std::vector<Change> result;
+    result.reserve(changes.size());
+    for (const auto &[key, count] : changes) {
+        Change change{count > 0, std::string(names.name(key[0])), {}};
+        for (std::size_t i = 1; i < key.size(); ++i) change.body.emplace_back(names.name(key[i]));
+        result.push_back(std::move(change));
+    }
+    changes.clear();
+    // Verwijderingen eerst: een hergebruikte naam verdwijnt voor ze terugkomt
+    std::sort(result.begin(), result.end(), [](const Change &a, const Change &b) {
+        return std::tie(a.added, a.head, a.body) < std::tie(b.added, b.head, b.body);
+    });
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------
+// Uitlezen
+
+Grammar IncrementalCNF::toGrammar() const {
+    Grammar grammar;
+    std::vector<Id> out(names.size(), SymbolTable::npos);
+    auto outId = [&](Id id) {
+        if (out[id] == SymbolTable::npos) {
+            const Id from = sourceOf[id];
+            out[id] = from == SymbolTable::npos || variable[from] ? grammar.addVariable(names.name(id))
+                                                                 : grammar.addTerminal(names.name(id));
+        }
+        return out[id];
+    };
+    if (start != SymbolTable::npos && generating[start] && reachable[start]) {
+        grammar.startSymbol = outId(nameOf[start]);
+    }
+    grammar.acceptsEmpty = start != SymbolTable::npos && nullable[start];
+
+    std::vector<Id> body;
+    for (Id rule = 0; rule < cnf.slots(); ++rule) {
+        if (!cnf.live(rule)) continue;
+        const auto &r = cnf[rule];
+        Id head = outId(r.head);
+        body.clear();
+        for (Id symbol : r.body) body.push_back(outId(symbol));
+        grammar.addProduction(head, body.data(), body.size());
+    }
+    return grammar;
+}
+
+CFG IncrementalCNF::toCFG() const {
+    CFG cfg(toGrammar());
+    if (start != SymbolTable::npos) cfg.startSymbol = symbols.name(start);
+    return cfg;
+}
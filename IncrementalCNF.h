@@ -0,0 +1,165 @@
+#ifndef INCREMENTALCNF_H
+#define INCREMENTALCNF_H
+
+#include "CFG.h"
+#include "Grammar.h"
+#include <cstddef>
+#include <map>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// CNF-conversie die bijgehouden wordt terwijl producties toegevoegd of verwijderd worden.
+// Dezelfde stappen als CFG::toCNF, maar elke tussenvorm blijft bestaan met referentietellingen:
+//   bron  --epsilon-->  expanded  --unit-->  unitFree  --nutteloos, terminals, opsplitsen-->  cnf
+// Nullable, de unit-sluiting en genererend/bereikbaar worden bij een wijziging enkel herrekend
+// voor de symbolen die erdoor geraakt worden (toevoegen: doorpropageren; verwijderen:
+// kandidaten schrappen en opnieuw afleiden).
+//
+// Elke nuttige regel van unitFree heeft zijn eigen CNF-regels in cnf: de keten A -> X A_n, ...
+// met verse variabelen die enkel van die regel zijn, en een gedeelde "_t" -> t per terminal, met
+// als telling het aantal regels dat hem gebruikt. Na een wijziging worden enkel de regels van
+// symbolen waarvan genererend of bereikbaar veranderde opnieuw bekeken (sync). Een verse naam
+// blijft dezelfde zolang zijn regel bestaat; krijgt een later toegevoegd symbool die naam, dan
+// krijgen de betrokken regels een nieuwe. takeChanges geeft zo het netto verschil in de CNF.
+//
+// Zoals CFG::toCNF gooit een wijziging std::length_error als een bronregel meer varianten zou
+// geven dan productionLimit, of als de tussenvormen groter worden dan die grens. De toestand is
+// dan die van voor de wijziging.
+class IncrementalCNF {
+public:
+    using Id = SymbolTable::Id;
+
+    explicit IncrementalCNF(std::size_t productionLimit = CFG::defaultProductionLimit)
+            : productionLimit(productionLimit) {}
+    explicit IncrementalCNF(const CFG &cfg, std::size_t productionLimit = CFG::defaultProductionLimit);
+
+    void setStartSymbol(std::string_view name);
+    // body: symbolen gescheiden door spaties, zoals in CFG::addProduction
+    bool addProduction(std::string_view head, std::string_view body);     // false als ze al bestond
+    bool removeProduction(std::string_view head, std::string_view body);  // false als ze niet bestond
+
+    bool isNullable(std::string_view symbol) const;
+    bool isUseful(std::string_view symbol) const;
+    std::size_t sourceProductionCount() const { return source.size(); }
+
+    Grammar toGrammar() const;  // Huidige CNF (verse variabelen "_t" en "A_n" zoals toCNF, acceptsEmpty ook), kopie van cnf
+    CFG toCFG() const;
+
+    // Netto wijzigingen in de CNF van toGrammar sinds de vorige oproep (of sinds de constructor),
+    // gesorteerd; een mislukte wijziging laat hoogstens hernoemde regels achter
+    struct Change {
+        bool added;
+        std::string head;
+        std::vector<std::string> body;
+    };
+    std::vector<Change> takeChanges();
+
+private:
+    // Producties zonder dubbels, met referentietelling en een head- en voorkomen-index
+    class RuleSet {
+    public:
+        struct Rule {
+            Id head;
+            std::vector<Id> body;
+        };
+
+        std::pair<Id, bool> acquire(Id head, const std::vector<Id> &body);  // (regel, nieuw?)
+        bool release(Id rule);  // true als de laatste referentie wegviel; de inhoud blijft leesbaar
+        Id find(Id head, const std::vector<Id> &body) const;
+
+        const Rule &operator[](Id rule) const { return rules[rule]; }
+        bool live(Id rule) const { return refs[rule] > 0; }
+        std::size_t slots() const { return rules.size(); }
+        std::size_t size() const { return liveCount; }
+        const std::vector<Id> &byHead(Id symbol) const { return heads[symbol]; }
+        const std::vector<Id> &occurrences(Id symbol) const { return uses[symbol]; }
+        void resize(std::size_t symbols);
+
+    private:
+        struct KeyHash {
+            std::size_t operator()(const std::vector<Id> &key) const;
+        };
+
+        std::vector<Rule> rules;
+        std::vector<std::uint32_t> refs;
+        std::vector<Id> freeSlots;
+        std::unordered_map<std::vector<Id>, Id, KeyHash> index;  // [head, body...] -> regel
+        std::vector<std::vector<Id>> heads;
+        std::vector<std::vector<Id>> uses;  // elke regel een keer per symbool
+        std::size_t liveCount = 0;
+
+        static std::vector<Id> key(Id head, const std::vector<Id> &body);
+    };
+
+    std::size_t productionLimit;
+    SymbolTable symbols;
+    std::vector<char> variable;
+    Id start = SymbolTable::npos;
+
+    RuleSet source;    // producties zoals toegevoegd
+    RuleSet expanded;  // na epsilon-eliminatie; telling = aantal bronregels met deze variant
+    RuleSet unitFree;  // na unit-eliminatie; telling = aantal (A, B, regel van B) met B in sluiting(A)
+    std::vector<std::vector<Id>> variants;  // per bronregel zijn regels in expanded
+
+    std::vector<char> nullable;    // over source
+    std::vector<char> generating;  // over unitFree; terminals altijd 1
+    std::vector<char> reachable;   // over unitFree, enkel via volledig genererende regels
+    std::vector<std::unordered_set<Id>> closure;    // A =>* B via unit-regels in expanded (reflexief)
+    std::vector<std::unordered_set<Id>> coclosure;  // omgekeerd: alle A met B in sluiting(A)
+
+    // Uitvoer. names bevat de bronsymbolen die in de CNF komen en de verse variabelen; een
+    // naam krijgt er een vast id, ook als de verse variabele vrijkomt (dan wordt ze hergebruikt).
+    enum class Role : char { Free, Chain, Terminal, Source };
+    SymbolTable names;
+    std::vector<Role> roles;         // per id in names
+    std::vector<Id> owners;          // Chain: regel van unitFree, Terminal: de bronterminal
+    std::vector<Id> nameOf;          // bronsymbool -> id in names
+    std::vector<Id> sourceOf;        // id in names -> bronsymbool, npos voor verse variabelen
+    RuleSet cnf;                     // over names; elke regel met telling 1
+    std::vector<std::vector<Id>> emitted;      // per regel van unitFree zijn regels in cnf, keten in volgorde
+    std::vector<Id> terminalVar;               // bronterminal -> "_t" in names, npos zonder gebruikers
+    std::vector<std::uint32_t> terminalUsers;  // actieve regels met die terminal in een lange body
+    std::vector<std::vector<Id>> spareChain;   // per bronhead: vrijgekomen ketenvariabelen
+    std::vector<int> chainCount;               // per bronhead: hoogste n tot nu toe in "A_n"
+    std::vector<Id> dirtyHeads;                // genererend of bereikbaar veranderd
+    std::vector<Id> dirtyBodies;               // genererend veranderd
+    std::vector<Id> dirtyRules;                // regels van unitFree die nieuw zijn of hernoemd moeten
+    bool dirtyAll = false;
+    std::map<std::vector<Id>, int> changes;    // [head, body...] in names -> +1 toegevoegd, -1 weg
+
+    Id symbol(std::string_view name, bool head, bool &kindChanged);
+    std::vector<Id> tokens(std::string_view body, bool &kindChanged);
+    void grow();
+    std::vector<std::pair<Id, std::vector<Id>>> sourceRules() const;
+    void rebuild(const std::vector<std::pair<Id, std::vector<Id>>> &rules);
+    void addSource(Id head, const std::vector<Id> &body);
+    void removeSource(Id rule);
+
+    bool isUnit(const std::vector<Id> &body) const { return body.size() == 1 && variable[body[0]]; }
+    void expand(Id rule);
+    void releaseExpanded(Id rule);
+    void addUnitEdge(Id from, Id to);
+    void removeUnitEdge(Id from);
+    void acquireUnitFree(Id head, const std::vector<Id> &body);
+    void releaseUnitFree(Id head, const std::vector<Id> &body);
+    void markReachable(std::vector<Id> work);
+    void retractReachable(std::vector<Id> seeds);
+    bool enabled(const RuleSet::Rule &rule) const;
+
+    bool available(const std::string &name) const;
+    Id freshName(const std::string &name, Role role, Id owner);
+    Id chainVariable(Id head, Id owner);
+    void emitRule(Id head, const std::vector<Id> &body, std::vector<Id> &rules);
+    void releaseRule(Id rule);
+    void emit(Id rule);
+    void retire(Id rule);
+    void rename(Id id);
+    void sync();
+    template <typename F>
+    void editing(F change);
+};
+
+#endif // INCREMENTALCNF_H
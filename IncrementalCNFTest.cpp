@@ -0,0 +1,243 @@
+// Differentiële test: IncrementalCNF na willekeurige reeksen toevoegingen en verwijderingen
+// tegenover CFG::toCNF op dezelfde producties. Verse variabelen ("_t", "A_n") krijgen in beide
+// een andere naam; ze hebben elk precies een regel en worden daarom teruggevouwen tot bodies
+// over de oorspronkelijke symbolen, waarna de verzamelingen regels gelijk moeten zijn. De
+// wijzigingen uit takeChanges, opgeteld, moeten telkens precies toGrammar geven.
+//
+//   ./PDA2CFG_incremental_test [steps] [seed]
+#include "CFG.h"
+#include "IncrementalCNF.h"
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <stdexcept>
+
+namespace {
+    using Rules = std::set<std::pair<std::string, std::vector<std::string>>>;
+
+    // Variabelen zijn hoofdletters; 'E' is pas een variabele zodra hij een head geweest is
+    const std::vector<std::string> declared = {"S", "A", "B", "C"};
+    const std::vector<std::string> symbolPool = {"S", "A", "B", "C", "E", "a", "b"};
+    const std::vector<std::string> headPool = {"S", "A", "B", "C", "E"};
+
+    int failures = 0;
+
+    void fail(const std::string &message) {
+        std::cerr << "FAIL: " << message << std::endl;
+        ++failures;
+    }
+
+    std::string text(const std::pair<std::string, std::vector<std::string>> &rule) {
+        std::string result = rule.first + " ->";
+        for (const auto &symbol : rule.second) result += " " + symbol;
+        return result;
+    }
+
+    // CNF-vorm controleren en verse variabelen terugvouwen; original: namen van voor de conversie
+    Rules unfold(const Grammar &grammar, const std::set<std::string> &original, const std::string &label) {
+        std::vector<std::vector<std::size_t>> byHead(grammar.symbolCount());
+        for (std::size_t p = 0; p < grammar.productionCount(); ++p) {
+            Grammar::Body body = grammar.body(p);
+            const bool binary = body.size() == 2 && grammar.isVariable(body[0]) && grammar.isVariable(body[1]);
+            const bool terminal = body.size() == 1 && !grammar.isVariable(body[0]);
+            if (!binary && !terminal) fail(label + ": production of " + std::string(grammar.name(grammar.head(p))) +
+                                           " is not in CNF");
+            byHead[grammar.head(p)].push_back(p);
+        }
+
+        std::function<void(Grammar::Id, std::vector<std::string> &)> inline_ = [&](Grammar::Id symbol,
+                                                                                   std::vector<std::string> &out) {
+            const std::string name(grammar.name(symbol));
+            if (original.count(name)) {
+                out.push_back(name);
+                return;
+            }
+            if (byHead[symbol].size() != 1) {
+                fail(label + ": fresh variable " + name + " has " + std::to_string(byHead[symbol].size()) +
+                     " productions");
+                return;
+            }
+            for (Grammar::Id s : grammar.body(byHead[symbol][0])) inline_(s, out);
+        };
+
+        Rules rules;
+        for (std::size_t p = 0; p < grammar.productionCount(); ++p) {
+            const std::string head(grammar.name(grammar.head(p)));
+            if (!original.count(head)) continue;
+            std::vector<std::string> body;
+            for (Grammar::Id s : grammar.body(p)) inline_(s, body);
+            rules.emplace(head, std::move(body));
+        }
+        return rules;
+    }
+
+    class Checker {
+    public:
+        Rules current;
+        std::set<std::string> variables{declared.begin(), declared.end()};
+        std::set<std::string> delta;  // CNF volgens takeChanges
+
+        void compare(IncrementalCNF &incremental, const std::string &label) {
+            CFG reference;
+            for (const auto &variable : variables) reference.addVariable(variable);
+            reference.startSymbol = "S";
+            std::set<std::string> original(variables);
+            for (const auto &symbol : symbolPool) {
+                original.insert(symbol);
+                if (!variables.count(symbol)) reference.terminals.insert(symbol[0]);
+            }
+            for (const auto &[head, body] : current) {
+                std::string joined;
+                for (const auto &symbol : body) joined += (joined.empty() ? "" : " ") + symbol;
+                reference.addProduction(head, joined);
+            }
+            reference.toCNF(Verbosity::Silent);
+
+            const Rules expected = unfold(reference.toGrammar(), original, label + " (toCNF)");
+            const Grammar actualGrammar = incremental.toGrammar();
+            const Rules actual = unfold(actualGrammar, original, label + " (incremental)");
+            if (actual != expected) {
+                fail(label + ": " + std::to_string(actual.size()) + " productions, expected " +
+                     std::to_string(expected.size()));
+                for (const auto &rule : expected) {
+                    if (!actual.count(rule)) std::cerr << "  missing " << text(rule) << std::endl;
+                }
+                for (const auto &rule : actual) {
+                    if (!expected.count(rule)) std::cerr << "  extra   " << text(rule) << std::endl;
+                }
+            }
+            // Het startsymbool staat er enkel als het nuttig is, dus precies als het regels heeft
+            const bool useful = std::any_of(expected.begin(), expected.end(),
+                                            [](const auto &rule) { return rule.first == "S"; });
+            if ((actualGrammar.startSymbol != SymbolTable::npos) != useful) fail(label + ": start symbol differs");
+            if (actualGrammar.acceptsEmpty != reference.acceptsEmpty) fail(label + ": acceptsEmpty differs");
+
+            for (const auto &change : incremental.takeChanges()) {
+                const std::string rule = text({change.head, change.body});
+                if (change.added ? !delta.insert(rule).second : !delta.erase(rule)) {
+                    fail(label + ": change " + (change.added ? "+ " : "- ") + rule + " does not apply");
+                }
+            }
+            std::set<std::string> productions;
+            for (std::size_t p = 0; p < actualGrammar.productionCount(); ++p) {
+                std::string rule = std::string(actualGrammar.name(actualGrammar.head(p))) + " ->";
+                for (Grammar::Id s : actualGrammar.body(p)) rule += " " + std::string(actualGrammar.name(s));
+                productions.insert(rule);
+            }
+            if (productions != delta) fail(label + ": changes do not add up to the CNF");
+        }
+    };
+
+    std::string join(const std::vector<std::string> &body) {
+        std::string joined;
+        for (const auto &symbol : body) joined += (joined.empty() ? "" : " ") + symbol;
+        return joined;
+    }
+
+    void randomSequence(unsigned seed, int steps) {
+        std::mt19937 random(seed);
+        auto pick = [&](const std::vector<std::string> &pool) { return pool[random() % pool.size()]; };
+
+        CFG initial;
+        for (const auto &variable : declared) initial.addVariable(variable);
+        initial.terminals = {'a', 'b', 'E'};
+        initial.startSymbol = "S";
+        IncrementalCNF incremental(initial);
+        Checker checker;
+
+        for (int step = 0; step < steps; ++step) {
+            const std::string label = "seed " + std::to_string(seed) + " step " + std::to_string(step);
+            if (!checker.current.empty() && random() % 3 == 0) {
+                auto it = checker.current.begin();
+                std::advance(it, random() % checker.current.size());
+                auto rule = *it;
+                if (!incremental.removeProduction(rule.first, join(rule.second))) fail(label + ": remove returned false");
+                checker.current.erase(rule);
+            } else {
+                std::vector<std::string> body(random() % 5);
+                for (auto &symbol : body) symbol = pick(symbolPool);
+                const std::string head = pick(headPool);
+                const bool fresh = checker.current.emplace(head, body).second;
+                if (incremental.addProduction(head, join(body)) != fresh) fail(label + ": add returned wrong result");
+                checker.variables.insert(head);
+            }
+            if (incremental.sourceProductionCount() != checker.current.size()) fail(label + ": wrong source count");
+            checker.compare(incremental, label);
+        }
+    }
+
+    // Te veel varianten: de wijziging wordt geweigerd en de vorige toestand blijft
+    void limit() {
+        CFG initial;
+        for (const auto &variable : declared) initial.addVariable(variable);
+        initial.terminals = {'a', 'b'};
+        initial.startSymbol = "S";
+        IncrementalCNF incremental(initial, 64);
+        Checker checker;
+        for (const auto &rule : Rules{{"A", {}}, {"A", {"a"}}, {"S", {"A", "A", "A", "b"}}}) {
+            incremental.addProduction(rule.first, join(rule.second));
+            checker.current.insert(rule);
+        }
+
+        try {
+            incremental.addProduction("S", "A A A A A A A b");
+            fail("limit: 7 nullable occurrences were accepted with a limit of 64");
+        } catch (const std::length_error &) {
+        }
+        checker.compare(incremental, "limit, after a long body");
+
+        // A was niet nullable: pas door de epsilon-regel worden alle varianten nodig
+        incremental.removeProduction("A", "");
+        checker.current.erase({"A", {}});
+        incremental.addProduction("S", "A A A A A A A b");
+        checker.current.insert({"S", {"A", "A", "A", "A", "A", "A", "A", "b"}});
+        try {
+            incremental.addProduction("A", "");
+            fail("limit: an epsilon production beyond the limit was accepted");
+        } catch (const std::length_error &) {
+        }
+        checker.compare(incremental, "limit, after an epsilon production");
+        if (incremental.isNullable("A")) fail("limit: A stayed nullable after the rejected change");
+    }
+
+    // Een later symbool met de naam van een verse variabele: de regels die haar gebruikten krijgen een andere
+    void renames() {
+        CFG initial;
+        for (const auto &variable : declared) initial.addVariable(variable);
+        initial.terminals = {'a', 'b'};
+        initial.startSymbol = "S";
+        IncrementalCNF incremental(initial);
+        Checker checker;
+        auto add = [&](const std::string &head, const std::vector<std::string> &body, const std::string &label) {
+            incremental.addProduction(head, join(body));
+            checker.current.emplace(head, body);
+            checker.variables.insert(head);
+            checker.compare(incremental, label);
+        };
+        add("S", {"a", "A", "B", "b"}, "renames, initial");
+        add("A", {"a"}, "renames, A");
+        add("B", {"b", "S"}, "renames, B");
+        add("S_2", {"b"}, "renames, S_2");
+        add("_a", {"S_2"}, "renames, _a");
+        add("S", {"_a", "a", "S_2"}, "renames, both");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const int steps = argc > 1 ? std::atoi(argv[1]) : 200;
+    const unsigned firstSeed = argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 1;
+
+    limit();
+    renames();
+    for (unsigned seed = firstSeed; seed < firstSeed + 40; ++seed) {
+        randomSequence(seed, steps);
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "IncrementalCNF matches toCNF" << std::endl;
+    return 0;
+}
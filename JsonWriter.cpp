@@ -0,0 +1,26 @@
+#include "JsonWriter.h"
+
+void writeJsonString(OutputSink &out, std::string_view text) {
+    static const char hex[] = "0123456789abcdef";
+    out.put('"');
+    std::size_t plain = 0;  // begin van het stuk dat zonder escapes gekopieerd kan worden
+    for (std::size_t i = 0; i < text.size(); ++i) {
+        unsigned char c = text[i];
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+        out.write(text.substr(plain, i - plain));
+        plain = i + 1;
+        switch (c) {
+            case '"': out.write("\\\""); break;
+            case '\\': out.write("\\\\"); break;
+            case '\n': out.write("\\n"); break;
+            case '\t': out.write("\\t"); break;
+            case '\r': out.write("\\r"); break;
+            default:
+                out.write("\\u00");
+                out.put(hex[c >> 4]);
+                out.put(hex[c & 15]);
+        }
+    }
+    out.write(text.substr(plain));
+    out.put('"');
+}
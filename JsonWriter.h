@@ -0,0 +1,10 @@
+#ifndef JSONWRITER_H
+#define JSONWRITER_H
+
+#include "OutputSink.h"
+#include <string_view>
+
+// Schrijft text als JSON-string (met aanhalingstekens en escapes) naar de sink.
+void writeJsonString(OutputSink &out, std::string_view text);
+
+#endif // JSONWRITER_H
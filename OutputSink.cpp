@@ -0,0 +1,71 @@
+#include "OutputSink.h"
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+
+OutputSink::OutputSink(std::FILE *file, std::size_t capacity)
+        : file(file), owned(false), name(file == stdout ? "standard output" : ""), buffer(capacity) {}
+
+OutputSink::OutputSink(const std::string &filename, std::size_t capacity)
+        : file(std::fopen(filename.c_str(), "wb")), owned(true), name(filename), buffer(capacity) {
+    if (!file) {
+        std::cerr << "Could not open file " << filename << std::endl;
+        exit(1);
+    }
+}
+
+OutputSink::OutputSink(std::string *target, std::size_t capacity)
+        : file(nullptr), owned(false), target(target), buffer(capacity) {}
+
+OutputSink::~OutputSink() {
+    close();
+}
+
+bool OutputSink::close() {
+    if (closed) return !failed;
+    flush();
+    closed = true;
+    if (target) return true;
+    errno = 0;
+    if ((owned ? std::fclose(file) : std::fflush(file)) != 0) fail();
+    return !failed;
+}
+
+void OutputSink::write(std::string_view text) {
+    if (text.size() > buffer.size() - used) {
+        flush();
+        if (text.size() >= buffer.size()) {
+            writeOut(text.data(), text.size());
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+}
+
+bool OutputSink::flush() {
+    if (used > 0) {
+        writeOut(buffer.data(), used);
+        used = 0;
+    }
+    return !failed;
+}
+
+void OutputSink::writeOut(const char *data, std::size_t size) {
+    if (target) {
+        target->append(data, size);
+        return;
+    }
+    if (failed || closed) return;
+    errno = 0;
+    if (std::fwrite(data, 1, size, file) != size) fail();
+}
+
+void OutputSink::fail() {
+    if (failed) return;
+    failed = true;
+    if (name.empty()) return;  // bestand van de oproeper: die kijkt zelf naar good() of ferror
+    std::cerr << "Could not write " << name;
+    if (errno != 0) std::cerr << ": " << std::strerror(errno);
+    std::cerr << std::endl;
+}
@@ -0,0 +1,57 @@
+#ifndef OUTPUTSINK_H
+#define OUTPUTSINK_H
+
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Gebufferde uitvoer naar stdout of een bestand. Schrijft in grote blokken via fwrite,
+// zodat grote grammatica's niet eerst volledig in het geheugen opgebouwd moeten worden.
+// Na een schrijffout (bv. een volle schijf) wordt verdere uitvoer weggegooid en blijft good()
+// false. Voor stdout en bestanden op naam wordt de fout ook een keer op stderr gemeld.
+class OutputSink {
+public:
+    static constexpr std::size_t defaultCapacity = 1 << 20;
+
+    explicit OutputSink(std::FILE *file = stdout, std::size_t capacity = defaultCapacity);
+    explicit OutputSink(const std::string &filename, std::size_t capacity = defaultCapacity);
+    explicit OutputSink(std::string *target, std::size_t capacity = defaultCapacity);  // achteraan aan *target
+    ~OutputSink();
+
+    OutputSink(const OutputSink &) = delete;
+    OutputSink &operator=(const OutputSink &) = delete;
+
+    void write(std::string_view text);
+    void put(char c) {
+        if (used == buffer.size()) flush();
+        buffer[used++] = c;
+    }
+    bool flush();  // false na een schrijffout
+    bool close();  // flush, en fclose voor een bestand op naam; de destructor doet het anders
+    bool good() const { return !failed; }
+
+    OutputSink &operator<<(std::string_view text) {
+        write(text);
+        return *this;
+    }
+    OutputSink &operator<<(char c) {
+        put(c);
+        return *this;
+    }
+
+private:
+    std::FILE *file;
+    bool owned;
+    std::string *target = nullptr;
+    std::string name;  // voor foutmeldingen; leeg = niet melden
+    std::vector<char> buffer;
+    std::size_t used = 0;
+    bool failed = false;
+    bool closed = false;
+
+    void writeOut(const char *data, std::size_t size);
+    void fail();
+};
+
+#endif // OUTPUTSINK_H
@@ -1,8 +1,12 @@
 #include "PDA.h"
 #include "CFG.h"
+#include "PDASimulator.h"
 #include "json.hpp"
+#include <algorithm>
+#include <array>
 #include <fstream>
 #include <iostream>
+#include <stdexcept>
 
 using json = nlohmann::json;
 
@@ -10,121 +14,546 @@ PDA::PDA(const std::string &filename) {
     loadFromFile(filename);
 }
 
+PDA::PDA(std::istream &input) {
+    load(input);
+}
+
+namespace {
+    // SAX-handler voor het PDA-bestand: symbolen worden geinterneerd zodra ze binnenkomen
+    // en elke transitie gaat meteen de tabel in, zonder ooit een json-DOM op te bouwen.
+    class PDALoader : public nlohmann::json_sax<json> {
+    public:
+        PDALoader(std::string &startState, std::string &startStack, std::set<std::string> &states,
+                  std::set<char> &alphabet, std::set<std::string> &stackAlphabet, TransitionTable &transitions)
+                : startState(startState), startStack(startStack), states(states), alphabet(alphabet),
+                  stackAlphabet(stackAlphabet), transitions(transitions) {}
+
+        bool null() override { return true; }
+        bool boolean(bool) override { return true; }
+        bool number_integer(number_integer_t) override { return true; }
+        bool number_unsigned(number_unsigned_t) override { return true; }
+        bool number_float(number_float_t, const string_t &) override { return true; }
+
+        bool string(string_t &val) override {
+            switch (context()) {
+                case Context::Root:
+                    if (topKey == "StartState") {
+                        startState = val;
+                        transitions.states.intern(val);
+                    } else if (topKey == "StartStack") {
+                        startStack = val;
+                        transitions.stackSymbols.intern(val);
+                    }
+                    break;
+                case Context::List:
+                    if (topKey == "States") {
+                        transitions.states.intern(val);
+                        states.insert(std::move(val));
+                    } else if (topKey == "Alphabet") {
+                        if (!val.empty()) alphabet.insert(val[0]);
+                    } else if (topKey == "StackAlphabet") {
+                        transitions.stackSymbols.intern(val);
+                        stackAlphabet.insert(std::move(val));
+                    }
+                    break;
+                case Context::Transition:
+                    for (std::size_t i = 0; i < requiredFields.size(); ++i) {
+                        if (field == requiredFields[i]) seen |= 1u << i;
+                    }
+                    if (field == "from") from = std::move(val);
+                    else if (field == "input") input = std::move(val);
+                    else if (field == "stacktop") stacktop = std::move(val);
+                    else if (field == "to") to = std::move(val);
+                    break;
+                case Context::Replacement:
+                    replacement.push_back(std::move(val));
+                    break;
+                default:
+                    break;
+            }
+            return true;
+        }
+
+        bool key(string_t &val) override {
+            if (context() == Context::Root) topKey = std::move(val);
+            else if (context() == Context::Transition) field = std::move(val);
+            return true;
+        }
+
+        bool start_object(std::size_t) override {
+            if (contexts.empty()) {
+                contexts.push_back(Context::Root);
+            } else if (context() == Context::Transitions) {
+                from.clear();
+                input.clear();
+                stacktop.clear();
+                to.clear();
+                replacement.clear();
+                seen = 0;
+                contexts.push_back(Context::Transition);
+            } else {
+                contexts.push_back(Context::Skip);
+            }
+            return true;
+        }
+
+        bool end_object() override {
+            if (context() == Context::Transition) {
+                // Zoals de oude DOM-loader: elk veld behalve replacement moet een string zijn
+                for (std::size_t i = 0; i < requiredFields.size(); ++i) {
+                    if (!(seen & (1u << i))) {
+                        throw std::runtime_error("Invalid PDA: transition " + std::to_string(transitionCount) +
+                                                 ": missing '" + requiredFields[i] + "'");
+                    }
+                }
+                transitions.add(from, input, stacktop, to, replacement);
+                ++transitionCount;
+            }
+            contexts.pop_back();
+            return true;
+        }
+
+        bool start_array(std::size_t) override {
+            Context next = Context::Skip;
+            if (context() == Context::Root) {
+                next = topKey == "Transitions" ? Context::Transitions : Context::List;
+            } else if (context() == Context::Transition && field == "replacement") {
+                next = Context::Replacement;
+            }
+            contexts.push_back(next);
+            return true;
+        }
+
+        bool end_array() override {
+            contexts.pop_back();
+            return true;
+        }
+
+        bool parse_error(std::size_t position, const std::string &, const nlohmann::detail::exception &ex) override {
+            throw std::runtime_error("Invalid PDA at byte " + std::to_string(position) + ": " + ex.what());
+        }
+
+    private:
+        enum class Context { Root, List, Transitions, Transition, Replacement, Skip };
+        static constexpr std::array<const char *, 4> requiredFields = {"from", "input", "stacktop", "to"};
+
+        std::string &startState;
+        std::string &startStack;
+        std::set<std::string> &states;
+        std::set<char> &alphabet;
+        std::set<std::string> &stackAlphabet;
+        TransitionTable &transitions;
+
+        std::vector<Context> contexts;
+        std::string topKey, field;
+        std::string from, input, stacktop, to;  // velden van de huidige transitie, hergebruikt
+        std::vector<std::string> replacement;
+        unsigned seen = 0;                       // bit i: requiredFields[i] gelezen
+        std::size_t transitionCount = 0;
+
+        Context context() const { return contexts.empty() ? Context::Skip : contexts.back(); }
+    };
+}
+
 void PDA::loadFromFile(const std::string &filename) {
     std::ifstream input(filename);
     if (!input) {
         std::cerr << "Could not open file " << filename << std::endl;
         exit(1);
     }
+    try {
+        load(input);
+    } catch (const std::runtime_error &error) {
+        std::cerr << filename << ": " << error.what() << std::endl;
+        exit(1);
+    }
+}
 
-    json j;
-    input >> j;
-
-    // Load PDA properties
-    startState = j["StartState"];
-    startStack = j["StartStack"];
+void PDA::load(std::istream &input) {
+    PDALoader loader(startState, startStack, states, alphabet, stackAlphabet, transitions);
+    json::sax_parse(input, &loader);
+    if (startState.empty() || startStack.empty()) {
+        throw std::runtime_error("Invalid PDA: StartState and StartStack are required");
+    }
+    // De triple-constructie gokt tussentoestanden uit States; een toestand die enkel in een
+    // transitie voorkomt zou de grammatica een andere taal geven dan de PDA zelf
+    for (TransitionTable::Id state = 0; state < transitions.states.size(); ++state) {
+        std::string name(transitions.states.name(state));
+        if (!states.count(name)) {
+            throw std::runtime_error("Invalid PDA: state '" + name + "' is not listed in States");
+        }
+    }
+    transitions.build();
+}
 
-    for (const auto &state : j["States"]) {
-        states.insert(state.get<std::string>());
+std::map<std::string, std::vector<std::string>> PDA::getCFGProductions(ThreadPool *pool) {
+    Grammar grammar = toGrammar(pool);
+    std::map<std::string, std::vector<std::string>> productions;
+    for (size_t p = 0; p < grammar.productionCount(); ++p) {
+        std::string body;
+        for (Grammar::Id symbol : grammar.body(p)) {
+            if (!body.empty()) body += ' ';
+            body += grammar.name(symbol);
+        }
+        productions[std::string(grammar.name(grammar.head(p)))].push_back(std::move(body));
     }
+    return productions;
+}
+
+Grammar PDA::toGrammar(ThreadPool *pool) {
+    using Id = TransitionTable::Id;
+    Grammar grammar;
+    const size_t Q = transitions.states.size();
+    const size_t G = transitions.stackSymbols.size();
+
+    // Grammatica-id per triple (p, X, q) in tabel-ids; na stap 1 enkel nog gelezen, dus thread-safe
+    std::vector<Grammar::Id> tripleIds(Q * G * Q, SymbolTable::npos);
+    std::string name;  // hergebruikte buffer voor "[p,X,q]"
+    auto triple = [&](Id p, Id X, Id q) {
+        Grammar::Id &id = tripleIds[(p * G + X) * Q + q];
+        if (id == SymbolTable::npos) {
+            name.clear();
+            name += '[';
+            name += transitions.states.name(p);
+            name += ',';
+            name += transitions.stackSymbols.name(X);
+            name += ',';
+            name += transitions.states.name(q);
+            name += ']';
+            id = grammar.addVariable(name);
+        }
+        return id;
+    };
 
-    for (const auto &symbol : j["Alphabet"]) {
-        alphabet.insert(symbol.get<std::string>()[0]);
+    std::vector<Id> declaredStates, declaredStacks;
+    std::vector<char> stackDeclared(G, 0);
+    for (const auto &state : states) {
+        declaredStates.push_back(transitions.states.find(state));
+    }
+    for (const auto &stackSymbol : stackAlphabet) {
+        declaredStacks.push_back(transitions.stackSymbols.find(stackSymbol));
+        stackDeclared[declaredStacks.back()] = 1;
     }
 
-    for (const auto &stackSym : j["StackAlphabet"]) {
-        stackAlphabet.insert(stackSym.get<std::string>());
+    // Stap 1: variabelen [state1, stack_symbol, state2] plus het startsymbool 'S' en de terminals
+    for (Id state1 : declaredStates) {
+        for (Id stackSymbol : declaredStacks) {
+            for (Id state2 : declaredStates) {
+                triple(state1, stackSymbol, state2);
+            }
+        }
+    }
+    grammar.startSymbol = grammar.addVariable("S");
+    for (const auto &symbol : alphabet) {
+        grammar.addTerminal(std::string(1, symbol));
+    }
+    std::vector<Grammar::Id> terminalIds(transitions.inputs.size());
+    for (Id input = 0; input < transitions.inputs.size(); ++input) {
+        terminalIds[input] = grammar.addTerminal(transitions.inputs.name(input));
     }
 
-    for (const auto &transition : j["Transitions"]) {
-        std::string from = transition["from"];
-        std::string input = transition["input"];
-        std::string stacktop = transition["stacktop"];
-        std::string to = transition["to"];
-        std::vector<std::string> replacement;
-        for (const auto &rep : transition["replacement"]) {
-            replacement.push_back(rep.get<std::string>());
+    // Triples met niet-gedeclareerde stapelsymbolen vooraf (serieel) interneren; alle toestanden
+    // staan in States, dat controleert load()
+    for (const auto &t : transitions.all()) {
+        const size_t pushCount = transitions.pushCount(t);
+        if (pushCount == 0) {
+            triple(t.from, t.top, t.to);
+            continue;
+        }
+        if (pushCount > 2) continue;
+        const Id push0 = transitions.push(t, 0);
+        for (Id q : declaredStates) {
+            if (!stackDeclared[t.top]) triple(t.from, t.top, q);
+            if (!stackDeclared[push0]) triple(t.to, push0, q);
+            if (pushCount == 2 && !stackDeclared[transitions.push(t, 1)]) {
+                for (Id m : declaredStates) triple(m, transitions.push(t, 1), q);
+            }
         }
-        transitions.emplace_back(from, input, stacktop, to, replacement);
     }
-}
 
-std::map<std::string, std::vector<std::string>> PDA::getCFGProductions() {
-    std::map<std::string, std::vector<std::string>> productions;
+    std::vector<Grammar::Id> body;
 
     // Start productions
-    for (const auto &state : states) {
-        productions["S"].push_back("[" + startState + "," + startStack + "," + state + "]");
-    }
-
-    // Process each transition in the PDA
-    for (const auto &transition : transitions) {
-        std::string fromState = std::get<0>(transition);
-        std::string inputSymbol = std::get<1>(transition);
-        std::string stackTop = std::get<2>(transition);
-        std::string toState = std::get<3>(transition);
-        std::vector<std::string> replacement = std::get<4>(transition);
-
-        if (replacement.empty()) {
-            // Case 1: empty replacement
-            std::string head = "[" + fromState + "," + stackTop + "," + toState + "]";
-            // If inputSymbol is not empty, use it as production; otherwise, add ε (empty production)
-            if (!inputSymbol.empty()) {
-                productions[head].push_back(inputSymbol);
-            } else {
-                productions[head].push_back(""); // epsilon production
-            }
-        } else if (replacement.size() == 1) {
-            // Case 2: Single symbol replacement
-            for (const auto &intermediateState : states) {
-                std::string head = "[" + fromState + "," + stackTop + "," + intermediateState + "]";
-                std::string body = inputSymbol + " [" + toState + "," + replacement[0] + "," + intermediateState + "]";
-                productions[head].push_back(body);
+    for (Id state : declaredStates) {
+        body.assign(1, triple(transitions.states.find(startState), transitions.stackSymbols.find(startStack), state));
+        grammar.addProduction(grammar.startSymbol, body);
+    }
+
+    // Stap 2: elke transitie genereert onafhankelijk |Q| of |Q|^2 producties; de transities
+    // worden in blokken verdeeld, elk blok schrijft in een eigen buffer
+    auto lookup = [&](Id p, Id X, Id q) { return tripleIds[(p * G + X) * Q + q]; };
+    const size_t transitionCount = transitions.size();
+    const size_t chunks = pool ? std::min(transitionCount, pool->size() * 8) : 1;
+    std::vector<ProductionBuffer> buffers(chunks);
+    auto generate = [&](size_t chunk) {
+        ProductionBuffer &out = buffers[chunk];
+        std::vector<Grammar::Id> local;
+        const TransitionTable::Transition *first = transitions.all().begin();
+        for (size_t i = chunk * transitionCount / chunks; i < (chunk + 1) * transitionCount / chunks; ++i) {
+            const auto &t = first[i];
+            const size_t pushCount = transitions.pushCount(t);
+            local.clear();
+            if (t.input != TransitionTable::epsilon) {
+                local.push_back(terminalIds[t.input]);
             }
-        } else if (replacement.size() == 2) {
-            // Case 3: Double symbol replacement
-            for (const auto &intermediateState1 : states) {
-                for (const auto &intermediateState2 : states) {
-                    std::string head = "[" + fromState + "," + stackTop + "," + intermediateState1 + "]";
-                    std::string body = inputSymbol + " [" + toState + "," + replacement[0] + "," + intermediateState2 + "] [" + intermediateState2 + "," + replacement[1] + "," + intermediateState1 + "]";
-                    productions[head].push_back(body);
+            const size_t prefix = local.size();
+
+            if (pushCount == 0) {
+                out.add(lookup(t.from, t.top, t.to), local.data(), local.size());
+            } else if (pushCount == 1) {
+                const Id push0 = transitions.push(t, 0);
+                for (Id intermediateState : declaredStates) {
+                    local.resize(prefix);
+                    local.push_back(lookup(t.to, push0, intermediateState));
+                    out.add(lookup(t.from, t.top, intermediateState), local.data(), local.size());
+                }
+            } else if (pushCount == 2) {
+                const Id push0 = transitions.push(t, 0);
+                const Id push1 = transitions.push(t, 1);
+                for (Id intermediateState1 : declaredStates) {
+                    Grammar::Id head = lookup(t.from, t.top, intermediateState1);
+                    for (Id intermediateState2 : declaredStates) {
+                        local.resize(prefix);
+                        local.push_back(lookup(t.to, push0, intermediateState2));
+                        local.push_back(lookup(intermediateState2, push1, intermediateState1));
+                        out.add(head, local.data(), local.size());
+                    }
                 }
             }
         }
+    };
+    if (pool && chunks > 1) {
+        pool->parallelFor(0, chunks, generate);
+    } else {
+        for (size_t chunk = 0; chunk < chunks; ++chunk) generate(chunk);
     }
 
-    return productions;
+    // Stap 3: buffers in volgorde samenvoegen, dus dezelfde productievolgorde als serieel
+    for (const auto &buffer : buffers) {
+        grammar.append(buffer);
+    }
+    return grammar;
 }
 
+Grammar PDA::toPrunedGrammar() {
+    const int start = static_cast<int>(transitions.states.find(startState));
+    const int bottom = static_cast<int>(transitions.stackSymbols.find(startStack));
+
+    // Zelfde toestanden als toGrammar: load() laat enkel toestanden uit States toe
+    const size_t Q = transitions.states.size();
+    const size_t G = transitions.stackSymbols.size();
+    auto key = [&](int p, int X) { return p * G + X; };
+    auto tripleIndex = [&](int p, int X, int q) { return key(p, X) * Q + q; };
 
+    // Transities geindexeerd op hun eerste en tweede push (van boven); (p, X) zit al in de tabel
+    struct Move {
+        int from, top, to;
+        int pushCount, push0, push1;
+    };
+    std::vector<Move> moves;
+    std::vector<std::vector<int>> byFirst(Q * G), bySecond(G);
+    for (const auto &t : transitions.all()) {
+        Move move{static_cast<int>(t.from), static_cast<int>(t.top), static_cast<int>(t.to),
+                  static_cast<int>(transitions.pushCount(t)), 0, 0};
+        if (move.pushCount > 2) continue;  // net als getCFGProductions
+        if (move.pushCount > 0) move.push0 = static_cast<int>(transitions.push(t, 0));
+        if (move.pushCount > 1) move.push1 = static_cast<int>(transitions.push(t, 1));
+        if (move.pushCount >= 1) byFirst[key(move.to, move.push0)].push_back(static_cast<int>(moves.size()));
+        if (move.pushCount == 2) bySecond[move.push1].push_back(static_cast<int>(moves.size()));
+        moves.push_back(move);
+    }
 
+    // Stap 1: productieve triples [p,X,q] (X kan gepopt worden van p naar q), worklist tot fixpunt
+    std::vector<char> productive(Q * G * Q, 0);
+    std::vector<std::vector<int>> productiveTo(Q * G);  // (p,X) -> alle q met [p,X,q] productief
+    std::vector<size_t> work;
+    auto markProductive = [&](int p, int X, int q) {
+        size_t idx = tripleIndex(p, X, q);
+        if (!productive[idx]) {
+            productive[idx] = 1;
+            productiveTo[key(p, X)].push_back(q);
+            work.push_back(idx);
+        }
+    };
+    for (const Move &move : moves) {
+        if (move.pushCount == 0) markProductive(move.from, move.top, move.to);
+    }
+    while (!work.empty()) {
+        size_t idx = work.back();
+        work.pop_back();
+        int r = static_cast<int>(idx / (G * Q));
+        int Y = static_cast<int>(idx / Q % G);
+        int m = static_cast<int>(idx % Q);
 
-CFG PDA::toCFG() {
-    CFG cfg;
-    // Define non-terminals in the format [state1, stack_symbol, state2]
-    for (const auto& state1 : states) {
-        for (const auto& stackSymbol : stackAlphabet) {
-            for (const auto& state2 : states) {
-                std::string nonTerminal = "[" + state1 + "," + stackSymbol + "," + state2 + "]";
-                cfg.nonTerminals.insert(nonTerminal);
+        // [r,Y,m] als eerste deel van een push
+        for (int i : byFirst[key(r, Y)]) {
+            const Move &move = moves[i];
+            if (move.pushCount == 1) {
+                markProductive(move.from, move.top, m);
+            } else {
+                const std::vector<int> &tails = productiveTo[key(m, move.push1)];
+                for (size_t t = 0; t < tails.size(); ++t) {
+                    markProductive(move.from, move.top, tails[t]);
+                }
+            }
+        }
+        // [r,Y,m] als tweede deel van een push van twee symbolen
+        for (int i : bySecond[Y]) {
+            const Move &move = moves[i];
+            if (productive[tripleIndex(move.to, move.push0, r)]) {
+                markProductive(move.from, move.top, m);
             }
         }
     }
 
-    // Add the start symbol 'S' to non-terminals
-    cfg.nonTerminals.insert("S");
+    // Stap 2: enkel producties emitteren voor triples bereikbaar vanuit [start,Z0,*]
+    Grammar grammar;
+    std::string name;
+    auto intern = [&](int p, int X, int q) {
+        name.clear();
+        name += '[';
+        name += transitions.states.name(p);
+        name += ',';
+        name += transitions.stackSymbols.name(X);
+        name += ',';
+        name += transitions.states.name(q);
+        name += ']';
+        return grammar.addVariable(name);
+    };
+    grammar.startSymbol = grammar.addVariable("S");
+    for (const auto &symbol : alphabet) {
+        grammar.addTerminal(std::string(1, symbol));
+    }
+
+    // Grammatica-id per bereikte triple, zoals tripleIds in toGrammar: enkel bij het eerste
+    // bezoek een naam opbouwen en interneren
+    std::vector<Grammar::Id> tripleIds(Q * G * Q, SymbolTable::npos);
+    auto reach = [&](int p, int X, int q) {
+        const size_t idx = tripleIndex(p, X, q);
+        if (tripleIds[idx] == SymbolTable::npos) {
+            tripleIds[idx] = intern(p, X, q);
+            work.push_back(idx);
+        }
+        return tripleIds[idx];
+    };
+    std::vector<Grammar::Id> terminalIds(transitions.inputs.size(), SymbolTable::npos);
+    auto terminal = [&](TransitionTable::Id input) {
+        if (terminalIds[input] == SymbolTable::npos) {
+            terminalIds[input] = grammar.addTerminal(transitions.inputs.name(input));
+        }
+        return terminalIds[input];
+    };
+
+    std::vector<Grammar::Id> body;
+    for (int q : productiveTo[key(start, bottom)]) {
+        body.assign(1, reach(start, bottom, q));
+        grammar.addProduction(grammar.startSymbol, body);
+    }
+
+    for (size_t next = 0; next < work.size(); ++next) {
+        size_t idx = work[next];
+        int p = static_cast<int>(idx / (G * Q));
+        int X = static_cast<int>(idx / Q % G);
+        int q = static_cast<int>(idx % Q);
+        const Grammar::Id head = tripleIds[idx];
+
+        for (const auto &t : transitions.from(p, X)) {
+            const size_t pushCount = transitions.pushCount(t);
+            if (pushCount > 2) continue;
+            const int to = static_cast<int>(t.to);
+            body.clear();
+            if (t.input != TransitionTable::epsilon) {
+                body.push_back(terminal(t.input));
+            }
+            const size_t prefix = body.size();
 
-    // Add PDA's input alphabet symbols as terminals in CFG
-    for (const auto& symbol : alphabet) {
-        cfg.terminals.insert(symbol);
+            if (pushCount == 0) {
+                if (to == q) grammar.addProduction(head, body);
+            } else if (pushCount == 1) {
+                const int push0 = static_cast<int>(transitions.push(t, 0));
+                if (productive[tripleIndex(to, push0, q)]) {
+                    body.push_back(reach(to, push0, q));
+                    grammar.addProduction(head, body);
+                }
+            } else {
+                const int push0 = static_cast<int>(transitions.push(t, 0));
+                const int push1 = static_cast<int>(transitions.push(t, 1));
+                for (int m : productiveTo[key(to, push0)]) {
+                    if (!productive[tripleIndex(m, push1, q)]) continue;
+                    body.resize(prefix);
+                    body.push_back(reach(to, push0, m));
+                    body.push_back(reach(m, push1, q));
+                    grammar.addProduction(head, body);
+                }
+            }
+        }
     }
 
-    // Add production rules
-    cfg.productionRules = getCFGProductions();
+    return grammar;
+}
 
-    // Set start symbol
-    cfg.startSymbol = "S";
+// Bovengrens van de triple-constructie, zonder ze uit te voeren: |Q| startproducties, per
+// transitie 1, |Q| of |Q|^2 producties naargelang het aantal gepushte symbolen, |Q|^2 |Γ| triples
+void PDA::checkTripleSize(std::size_t limit) const {
+    if (limit == SIZE_MAX) return;
+    // Vermenigvuldigen en optellen verzadigen net boven de grens
+    auto times = [limit](std::size_t a, std::size_t b) { return a != 0 && b > limit / a ? limit + 1 : a * b; };
+    auto plus = [limit](std::size_t a, std::size_t b) { return b > limit - std::min(a, limit) ? limit + 1 : a + b; };
+    const std::size_t Q = std::max(transitions.states.size(), states.size());
+    const std::size_t G = std::max(transitions.stackSymbols.size(), stackAlphabet.size());
 
+    const std::size_t triples = times(times(Q, G), Q);
+    if (triples > limit) {
+        throw std::length_error("triple construction: " + std::to_string(Q) + " states and " + std::to_string(G) +
+                                " stack symbols give more than " + std::to_string(limit) + " variables");
+    }
+    std::size_t productions = Q;
+    for (const auto &t : transitions.all()) {
+        const std::size_t pushCount = transitions.pushCount(t);
+        if (pushCount <= 2) productions = plus(productions, pushCount == 0 ? 1 : pushCount == 1 ? Q : times(Q, Q));
+    }
+    if (productions > limit) {
+        throw std::length_error("triple construction: more than " + std::to_string(limit) + " productions");
+    }
+}
+
+CFG PDA::toCFG(bool pruned, ThreadPool *pool, std::size_t productionLimit) {
+    checkTripleSize(productionLimit);
+    // Canoniek, zodat de uitvoer (en toCNF erop) niet afhangt van de volgorde in het bestand,
+    // en gelijk is met of zonder cache
+    CFG cfg(pruned ? toPrunedGrammar() : toGrammar(pool));
+    cfg.canonicalize();
     return cfg;
 }
 
+bool PDA::accepts(const std::string &input) const {
+    return PDASimulator(*this).accepts(input);
+}
+
+Fingerprint PDA::fingerprint() const {
+    auto strings = [](const std::set<std::string> &names) {
+        std::vector<Fingerprint> elements;
+        for (const auto &name : names) elements.push_back(FingerprintBuilder().add(name).finish());
+        return elements;
+    };
+    std::vector<Fingerprint> symbols;
+    for (char symbol : alphabet) symbols.push_back(FingerprintBuilder().add(std::string_view(&symbol, 1)).finish());
+
+    std::vector<Fingerprint> elements;
+    for (const auto &t : transitions.all()) {
+        FingerprintBuilder element;
+        element.add(transitions.states.name(t.from)).add(transitions.inputName(t));
+        element.add(transitions.stackSymbols.name(t.top)).add(transitions.states.name(t.to));
+        element.add(static_cast<std::uint64_t>(transitions.pushCount(t)));
+        for (std::size_t i = 0; i < transitions.pushCount(t); ++i) {
+            element.add(transitions.stackSymbols.name(transitions.push(t, i)));
+        }
+        elements.push_back(element.finish());
+    }
+
+    FingerprintBuilder builder;
+    builder.add("pda").add(startState).add(startStack);
+    builder.addUnordered(strings(states)).addUnordered(std::move(symbols));
+    builder.addUnordered(strings(stackAlphabet)).addUnordered(std::move(elements));
+    return builder.finish();
+}
@@ -2,25 +2,44 @@
 #define PDA_H
 
 #include "CFG.h"
+#include "Fingerprint.h"
+#include "ThreadPool.h"
+#include "TransitionTable.h"
+#include <cstdint>
+#include <istream>
 #include <string>
 #include <map>
 #include <vector>
 
 class PDA {
+    friend class PDASimulator;
+
 private:
     std::string startState;
     std::string startStack;
     std::set<std::string> states;
     std::set<char> alphabet;
     std::set<std::string> stackAlphabet;
-    std::vector<std::tuple<std::string, std::string, std::string, std::string, std::vector<std::string>>> transitions;
+    TransitionTable transitions;
 
     void loadFromFile(const std::string &filename);
+    void load(std::istream &input);
+    void checkTripleSize(std::size_t limit) const;
 
 public:
     PDA(const std::string &filename);
-    std::map<std::string, std::vector<std::string>> getCFGProductions();
-    CFG toCFG();
+    explicit PDA(std::istream &input);  // JSON in hetzelfde formaat als het bestand; std::runtime_error bij een fout
+    std::map<std::string, std::vector<std::string>> getCFGProductions(ThreadPool *pool = nullptr);
+    Grammar toGrammar(ThreadPool *pool = nullptr);  // Triple-constructie rechtstreeks in geinterneerde vorm
+    Grammar toPrunedGrammar();  // Enkel bereikbare en productieve triples
+    // Canoniek (CFG::canonicalize). Kan de triple-constructie meer dan productionLimit producties
+    // of triples geven, dan std::length_error voor er iets gealloceerd wordt (|Q|^2 |Γ| triples).
+    CFG toCFG(bool pruned = false, ThreadPool *pool = nullptr, std::size_t productionLimit = SIZE_MAX);
+
+    bool accepts(const std::string &input) const;  // Directe simulatie, aanvaarding met lege stapel
+
+    // Onafhankelijk van de volgorde van toestanden, alfabetten en transities in het bestand
+    Fingerprint fingerprint() const;
 };
 
 #endif // PDA_H
@@ -0,0 +1,143 @@
+#include "PDASimulator.h"
+#include "PDA.h"
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+
+PDASimulator::PDASimulator(const PDA &pda) : transitions(pda.transitions) {
+    inputOf.fill(SymbolTable::npos);
+    for (TransitionTable::Id id = 0; id < transitions.inputs.size(); ++id) {
+        std::string_view label = transitions.inputs.name(id);
+        if (label.size() == 1) {
+            inputOf[static_cast<unsigned char>(label[0])] = id;
+        } else {
+            longLabels = true;
+        }
+    }
+    startState = transitions.states.find(pda.startState);
+    startStack = transitions.stackSymbols.find(pda.startStack);
+}
+
+bool PDASimulator::accepts(const std::string &input) const {
+    // Ouder van een knoop: na het poppen van het symbool gaat move verder met push[next]
+    // (of, als alles gepopt is, popt de ouderknoop zelf)
+    struct Parent {
+        std::uint32_t move;
+        std::uint32_t next;
+        std::uint32_t node;
+    };
+    struct Node {
+        TransitionTable::Id state, symbol;
+        std::size_t position;
+        std::vector<Parent> parents;
+        std::vector<std::pair<TransitionTable::Id, std::size_t>> pops;  // (q, j): symbool gepopt naar q op positie j
+    };
+    struct Task {
+        bool expand;
+        std::uint32_t node;  // expand: deze knoop uitbreiden
+        Parent parent;       // anders: parent hervatten met (state, position)
+        TransitionTable::Id state;
+        std::size_t position;
+    };
+
+    using Transition = TransitionTable::Transition;
+    const std::size_t n = input.size();
+    const std::size_t stateCount = transitions.states.size();
+    const std::size_t stackCount = transitions.stackSymbols.size();
+    const Transition *first = transitions.all().begin();
+    std::vector<Node> nodes;
+    std::unordered_map<std::uint64_t, std::uint32_t> nodeIndex;
+    std::unordered_set<std::uint64_t> seenPops;
+    std::vector<Task> work;
+    bool accepted = false;
+
+    // Sleutels als exacte 64-bit getallen: een knoop (i, p, X) telt tot (n+1)*|Q|*|Gamma|, een pop
+    // is de knoop boven popBits bits met j*|Q|+q. Past dat niet, dan gooien in plaats van botsen
+    // (een botsing zou een echte pop laten vallen en de invoer ten onrechte verwerpen).
+    const std::uint64_t max = std::numeric_limits<std::uint64_t>::max();
+    const std::uint64_t popRange = static_cast<std::uint64_t>(n + 1) * stateCount;
+    if (stateCount == 0 || stackCount == 0 || n + 1 > max / stateCount || popRange > max / stackCount) {
+        throw std::length_error("input of " + std::to_string(n) + " symbols is too long to simulate this PDA");
+    }
+    unsigned popBits = 0;
+    while (popBits < 64 && popRange > std::uint64_t(1) << popBits) ++popBits;
+    const std::uint64_t nodeLimit = popBits <= 32 ? std::uint64_t(1) << 32 : std::uint64_t(1) << (64 - popBits);
+
+    auto getNode = [&](TransitionTable::Id p, TransitionTable::Id X, std::size_t i) {
+        std::uint64_t key = (static_cast<std::uint64_t>(i) * stateCount + p) * stackCount + X;
+        auto it = nodeIndex.emplace(key, static_cast<std::uint32_t>(nodes.size()));
+        if (it.second) {
+            if (nodes.size() >= nodeLimit) {
+                throw std::length_error("input of " + std::to_string(n) + " symbols needs too many stack nodes");
+            }
+            nodes.push_back({p, X, i, {}, {}});
+            work.push_back({true, it.first->second, {}, 0, 0});
+        }
+        return it.first->second;
+    };
+    auto addParent = [&](std::uint32_t node, Parent parent) {
+        nodes[node].parents.push_back(parent);
+        for (const auto &pop : nodes[node].pops) {
+            work.push_back({false, 0, parent, pop.first, pop.second});
+        }
+    };
+    auto pop = [&](std::uint32_t node, TransitionTable::Id q, std::size_t j) {
+        std::uint64_t key = (static_cast<std::uint64_t>(node) << popBits) | (j * stateCount + q);
+        if (!seenPops.insert(key).second) return;
+        if (node == 0 && j == n) accepted = true;
+        nodes[node].pops.emplace_back(q, j);
+        for (const Parent &parent : nodes[node].parents) {
+            work.push_back({false, 0, parent, q, j});
+        }
+    };
+
+    auto apply = [&](std::uint32_t node, const Transition &t, std::size_t k) {
+        if (transitions.pushCount(t) == 0) {
+            pop(node, t.to, k);
+        } else {
+            std::uint32_t child = getNode(t.to, transitions.push(t, 0), k);
+            addParent(child, {static_cast<std::uint32_t>(&t - first), 1, node});
+        }
+    };
+
+    if (startState == SymbolTable::npos || startStack == SymbolTable::npos) return false;
+    getNode(startState, startStack, 0);
+    while (!work.empty() && !accepted) {
+        Task task = work.back();
+        work.pop_back();
+
+        if (!task.expand) {
+            const Transition &t = first[task.parent.move];
+            if (task.parent.next < transitions.pushCount(t)) {
+                std::uint32_t child = getNode(task.state, transitions.push(t, task.parent.next), task.position);
+                addParent(child, {task.parent.move, task.parent.next + 1, task.parent.node});
+            } else {
+                pop(task.parent.node, task.state, task.position);
+            }
+            continue;
+        }
+
+        // Enkel de transities voor (p, input[i], X) en (p, epsilon, X) uit de tabel halen
+        const TransitionTable::Id p = nodes[task.node].state;
+        const TransitionTable::Id X = nodes[task.node].symbol;
+        const std::size_t i = nodes[task.node].position;
+        for (const Transition &t : transitions.find(p, TransitionTable::epsilon, X)) {
+            apply(task.node, t, i);
+        }
+        if (i < n && inputOf[static_cast<unsigned char>(input[i])] != SymbolTable::npos) {
+            for (const Transition &t : transitions.find(p, inputOf[static_cast<unsigned char>(input[i])], X)) {
+                apply(task.node, t, i + 1);
+            }
+        }
+        if (longLabels) {
+            for (const Transition &t : transitions.from(p, X)) {
+                std::string_view label = transitions.inputName(t);
+                if (label.size() > 1 && input.compare(i, label.size(), label) == 0) {
+                    apply(task.node, t, i + label.size());
+                }
+            }
+        }
+    }
+    return accepted;
+}
@@ -0,0 +1,30 @@
+#ifndef PDASIMULATOR_H
+#define PDASIMULATOR_H
+
+#include "TransitionTable.h"
+#include <array>
+#include <cstdint>
+#include <string>
+
+class PDA;
+
+// Simuleert een niet-deterministische PDA rechtstreeks (aanvaarding met lege stapel).
+// De stapel is graph-structured: een knoop (p, X, i) staat voor "X werd de top in toestand p
+// op inputpositie i" en wordt gedeeld door alle configuraties die hem bereiken. Per knoop
+// worden de pops (q, j) gememoiseerd en opnieuw afgespeeld voor ouders die later aansluiten,
+// zodat epsilon-lussen en gedeelde suffixen maar een keer verwerkt worden.
+class PDASimulator {
+public:
+    explicit PDASimulator(const PDA &pda);
+
+    bool accepts(const std::string &input) const;
+
+private:
+    const TransitionTable &transitions;
+    std::array<TransitionTable::Id, 256> inputOf;  // inputsymbool-id per karakter (npos = onbekend)
+    bool longLabels = false;                       // inputlabels van meer dan een karakter
+    TransitionTable::Id startState;
+    TransitionTable::Id startStack;
+};
+
+#endif // PDASIMULATOR_H
@@ -0,0 +1,119 @@
+// Test van het inladen van PDA's en van de triple-constructie: de volledige en de gesnoeide
+// grammatica moeten dezelfde taal beschrijven als de PDA zelf (vergeleken met Earley en
+// de directe simulatie), en ongeldige bestanden (toestand buiten States, transitie zonder
+// een verplicht veld) moeten een std::runtime_error geven. Een grens op het aantal producties
+// moet de constructie weigeren voor ze iets alloceert.
+//
+//   ./PDA2CFG_pda_test
+#include "Earley.h"
+#include "PDA.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    int failures = 0;
+
+    void fail(const std::string &message) {
+        std::cerr << "FAIL: " << message << std::endl;
+        ++failures;
+    }
+
+    // Geeft de melding van de runtime_error, of "" als het laden lukt
+    std::string loadError(const std::string &text) {
+        std::istringstream input(text);
+        try {
+            PDA pda(input);
+        } catch (const std::runtime_error &error) {
+            return error.what();
+        }
+        return "";
+    }
+
+    void expectRejected(const std::string &label, const std::string &text, const std::string &message) {
+        const std::string error = loadError(text);
+        if (error.empty()) fail(label + ": accepted");
+        else if (error.find(message) == std::string::npos) fail(label + ": unexpected error '" + error + "'");
+    }
+
+    // p leest a, duwt X boven Z en gaat naar r; r popt X met a en Z met epsilon: taal {aa}
+    std::string pushPop(const std::string &states) {
+        return R"({"States": [)" + states + R"(], "Alphabet": ["a"], "StackAlphabet": ["X", "Z"],
+                  "StartState": "p", "StartStack": "Z", "Transitions": [
+                    {"from": "p", "input": "a", "stacktop": "Z", "to": "r", "replacement": ["X", "Z"]},
+                    {"from": "r", "input": "a", "stacktop": "X", "to": "r", "replacement": []},
+                    {"from": "r", "input": "", "stacktop": "Z", "to": "r", "replacement": []}]})";
+    }
+
+    // Een toestand die enkel in een transitie staat: de gewone constructie gokt tussentoestanden
+    // uit States en de gesnoeide uit de transities, dus zonder controle verschilt hun taal
+    void undeclaredState() {
+        expectRejected("undeclared state", pushPop(R"("p")"), "'r' is not listed in States");
+        expectRejected("undeclared start state",
+                       R"({"States": ["q"], "Alphabet": [], "StackAlphabet": ["Z"], "StartState": "p",
+                          "StartStack": "Z", "Transitions": []})",
+                       "'p' is not listed in States");
+    }
+
+    // Elk veld behalve replacement is verplicht; anders ontstaan variabelen als [p,,]
+    void missingFields() {
+        auto pda = [](const std::string &transition) {
+            return R"({"States": ["p"], "Alphabet": ["a"], "StackAlphabet": ["Z"], "StartState": "p",
+                      "StartStack": "Z", "Transitions": [
+                        {"from": "p", "input": "a", "stacktop": "Z", "to": "p", "replacement": []}, )" +
+                   transition + "]}";
+        };
+        expectRejected("missing stacktop and to", pda(R"({"from": "p", "input": "a"})"),
+                       "transition 1: missing 'stacktop'");
+        expectRejected("missing from", pda(R"({"input": "", "stacktop": "Z", "to": "p"})"),
+                       "transition 1: missing 'from'");
+        expectRejected("non-string input", pda(R"({"from": "p", "input": 1, "stacktop": "Z", "to": "p"})"),
+                       "transition 1: missing 'input'");
+        const std::string error = loadError(pda(R"({"from": "p", "input": "", "stacktop": "Z", "to": "p"})"));
+        if (!error.empty()) fail("transition without replacement: " + error);
+    }
+
+    void sameLanguage() {
+        std::istringstream input(pushPop(R"("p", "r")"));
+        PDA pda(input);
+        const Earley full(pda.toGrammar());
+        const Earley pruned(pda.toPrunedGrammar());
+        for (const std::string word : {"", "a", "aa", "aaa"}) {
+            const bool expected = pda.accepts(word);
+            if (expected != (word == "aa")) fail("simulator on '" + word + "'");
+            if (full.accepts(word) != expected) fail("toGrammar on '" + word + "'");
+            if (pruned.accepts(word) != expected) fail("toPrunedGrammar on '" + word + "'");
+        }
+    }
+
+    // pushPop met twee toestanden: 2 startproducties, 4 voor de push van twee symbolen, 2 pops
+    void productionLimit() {
+        for (bool pruned : {false, true}) {
+            const std::string label = pruned ? "pruned" : "full";
+            std::istringstream input(pushPop(R"("p", "r")"));
+            PDA pda(input);
+            try {
+                pda.toCFG(pruned, nullptr, 4);
+                fail(label + ": limit 4 not enforced");
+            } catch (const std::length_error &) {}
+            try {
+                if (pda.toCFG(pruned, nullptr, 100).productionCount() == 0) fail(label + ": empty grammar");
+            } catch (const std::length_error &) {
+                fail(label + ": limit 100 rejected");
+            }
+        }
+    }
+}
+
+int main() {
+    undeclaredState();
+    missingFields();
+    sameLanguage();
+    productionLimit();
+
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "PDA loading and triple construction agree" << std::endl;
+    return 0;
+}
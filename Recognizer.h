@@ -0,0 +1,14 @@
+#ifndef RECOGNIZER_H
+#define RECOGNIZER_H
+
+#include <cstddef>
+
+// Resultaat van een herkenning (CYK, Earley, ...) met tijdmeting
+struct RecognitionRun {
+    bool accepted;
+    double seconds;
+
+    double charsPerSecond(std::size_t length) const { return seconds > 0 ? length / seconds : 0; }
+};
+
+#endif // RECOGNIZER_H
@@ -0,0 +1,176 @@
+// Differentiële test van de herkenners: CYK (serieel en met een pool), Valiant en Earley
+// tegenover de directe simulatie van de PDA (PDASimulator). Per PDA worden woorden aanvaard
+// door een willekeurige wandeling door de PDA (tot de stapel leeg is), daarnaast varianten met
+// een teken gewijzigd of toegevoegd, en het lege woord. Woorden van 256 tekens of
+// meer geven Valiant blokken vanaf fourRussiansMin, dus ook het Four Russians-pad.
+//
+//   ./PDA2CFG_recognizer_test [pdas] [seed]
+#include "CYK.h"
+#include "Earley.h"
+#include "PDA.h"
+#include "Valiant.h"
+#include <cstdlib>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    int failures = 0;
+    std::size_t longAccepted = 0;  // aanvaarde woorden van 256 tekens of meer, over alle PDA's
+
+    void fail(const std::string &message) {
+        std::cerr << "FAIL: " << message << std::endl;
+        ++failures;
+    }
+
+    struct Move {
+        std::string from, input, top, to;
+        std::vector<std::string> push;  // bovenste eerst, zoals "replacement"
+    };
+
+    // PDA in het formaat van het invoerbestand; start in states[0] met stack[0]
+    struct Spec {
+        std::string name;
+        std::vector<std::string> states;
+        std::vector<std::string> stack;
+        std::vector<Move> moves;
+
+        std::string json() const {
+            auto list = [](const std::vector<std::string> &names) {
+                std::string out = "[";
+                for (std::size_t i = 0; i < names.size(); ++i) out += (i ? ", \"" : "\"") + names[i] + "\"";
+                return out + "]";
+            };
+            std::string out = "{\"States\": " + list(states) + ", \"Alphabet\": [\"a\", \"b\"], \"StackAlphabet\": " +
+                              list(stack) + ", \"StartState\": \"" + states[0] + "\", \"StartStack\": \"" + stack[0] +
+                              "\", \"Transitions\": [";
+            for (std::size_t i = 0; i < moves.size(); ++i) {
+                const Move &m = moves[i];
+                out += (i ? ", " : "") + std::string("{\"from\": \"") + m.from + "\", \"input\": \"" + m.input +
+                       "\", \"stacktop\": \"" + m.top + "\", \"to\": \"" + m.to + "\", \"replacement\": " +
+                       list(m.push) + "}";
+            }
+            return out + "]}";
+        }
+    };
+
+    // a^n b^n (n >= 1) en gebalanceerde woorden over a/b: lange woorden zijn er altijd
+    std::vector<Spec> fixedPDAs() {
+        return {
+                {"anbn", {"p", "q"}, {"Z", "A"},
+                 {{"p", "a", "Z", "p", {"A"}}, {"p", "a", "A", "p", {"A", "A"}},
+                  {"p", "b", "A", "q", {}}, {"q", "b", "A", "q", {}}}},
+                {"dyck", {"p"}, {"Z", "A"},
+                 {{"p", "a", "Z", "p", {"A", "Z"}}, {"p", "a", "A", "p", {"A", "A"}},
+                  {"p", "b", "A", "p", {}}, {"p", "", "Z", "p", {}}}},
+        };
+    }
+
+    // Elke (toestand, stapelsymbool) kan poppen en meestal ook pushen, zodat lange aanvaarde
+    // woorden bestaan; daarbovenop enkele volledig willekeurige transities
+    Spec randomPDA(std::mt19937 &random, unsigned index) {
+        Spec spec;
+        spec.name = "random " + std::to_string(index);
+        spec.states = {"p", "q", "r"};
+        spec.states.resize(1 + random() % 3);
+        spec.stack = {"Z", "X", "Y"};
+        auto pick = [&](const std::vector<std::string> &names) { return names[random() % names.size()]; };
+        auto input = [&] { return random() % 4 == 0 ? "" : (random() % 2 ? "a" : "b"); };
+        auto add = [&](const std::string &from, const std::string &top, std::size_t pushCount) {
+            Move move{from, input(), top, pick(spec.states), std::vector<std::string>(pushCount)};
+            for (auto &symbol : move.push) symbol = pick(spec.stack);
+            spec.moves.push_back(move);
+        };
+        for (const auto &state : spec.states) {
+            for (const auto &top : spec.stack) {
+                add(state, top, 0);
+                if (random() % 4 != 0) add(state, top, 1 + random() % 2);
+            }
+        }
+        for (std::size_t extra = random() % 4; extra > 0; --extra) add(pick(spec.states), pick(spec.stack), random() % 3);
+        return spec;
+    }
+
+    // Willekeurige aanvaardende berekening: zolang het woord korter is dan target worden pops
+    // van het laatste stapelsymbool vermeden, daarna krijgen pops voorrang. false als de
+    // wandeling vastloopt of het woord te lang wordt.
+    bool walk(const Spec &spec, std::mt19937 &random, std::size_t target, std::string &word) {
+        std::string state = spec.states[0];
+        std::vector<std::string> stack{spec.stack[0]};
+        word.clear();
+        for (std::size_t step = 0; step < 20 * target && word.size() <= target + 64; ++step) {
+            std::vector<const Move *> options, growing, popping;
+            for (const Move &move : spec.moves) {
+                if (move.from != state || move.top != stack.back()) continue;
+                options.push_back(&move);
+                if (stack.size() > 1 || !move.push.empty()) growing.push_back(&move);
+                if (move.push.empty()) popping.push_back(&move);
+            }
+            if (options.empty()) return false;
+            const auto &preferred = word.size() < target ? growing : popping;
+            const auto &choices = preferred.empty() ? options : preferred;
+            const Move &move = *choices[random() % choices.size()];
+            word += move.input;
+            state = move.to;
+            stack.pop_back();
+            stack.insert(stack.end(), move.push.rbegin(), move.push.rend());
+            if (stack.empty()) return true;
+        }
+        return false;
+    }
+
+    void check(const Spec &spec, std::mt19937 &random, ThreadPool &pool) {
+        std::istringstream input(spec.json());
+        PDA pda(input);
+        CFG cnf = pda.toCFG(true);
+        const Earley earley(cnf);
+        cnf.toCNF(Verbosity::Silent);
+        const CYK cyk(cnf);
+        const Valiant valiant(cnf);
+
+        std::vector<std::string> words{"", "a", "b", "ab"};
+        std::string word;
+        std::size_t longWords = 0;
+        for (int attempt = 0; attempt < 40 && longWords < 2; ++attempt) {
+            const std::size_t target = 256 + random() % 32;
+            if (!walk(spec, random, target, word)) continue;
+            words.push_back(word);
+            if (word.size() >= 256) {
+                ++longWords;
+                ++longAccepted;
+            }
+            if (word.empty()) continue;
+            std::string changed = word;
+            changed[random() % changed.size()] ^= 'a' ^ 'b';
+            words.push_back(changed);
+            words.push_back(word + (random() % 2 ? "a" : "b"));
+        }
+
+        for (const auto &w : words) {
+            const bool expected = pda.accepts(w);
+            const std::string where = spec.name + " on a word of " + std::to_string(w.size()) + " chars";
+            if (cyk.accepts(w) != expected) fail(where + ": CYK differs from the simulator");
+            if (cyk.accepts(w, &pool) != expected) fail(where + ": parallel CYK differs from the simulator");
+            if (valiant.accepts(w) != expected) fail(where + ": Valiant differs from the simulator");
+            if (earley.accepts(w) != expected) fail(where + ": Earley differs from the simulator");
+        }
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const unsigned pdas = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 10;
+    std::mt19937 random(argc > 2 ? static_cast<unsigned>(std::atoi(argv[2])) : 1);
+    ThreadPool pool(4);
+
+    for (const Spec &spec : fixedPDAs()) check(spec, random, pool);
+    for (unsigned i = 0; i < pdas; ++i) check(randomPDA(random, i), random, pool);
+
+    if (longAccepted == 0) fail("no accepted word of 256 chars or more was generated");
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "CYK, Valiant and Earley match the PDA simulator (" << longAccepted
+              << " accepted words of 256+ chars)" << std::endl;
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include "SymbolTable.h"
+#include <functional>
+
+SymbolTable::SymbolTable(const SymbolTable &other) {
+    reserve(other.size());
+    for (std::string_view name : other.names) {
+        intern(name);
+    }
+}
+
+SymbolTable &SymbolTable::operator=(const SymbolTable &other) {
+    if (this != &other) {
+        SymbolTable copy(other);
+        *this = std::move(copy);
+    }
+    return *this;
+}
+
+// Slot waar name staat, of het eerste lege slot van zijn probe-reeks
+std::size_t SymbolTable::slotOf(std::string_view name) const {
+    const std::size_t mask = slots.size() - 1;
+    std::size_t slot = std::hash<std::string_view>()(name) & mask;
+    while (slots[slot] != npos && names[slots[slot]] != name) {
+        slot = (slot + 1) & mask;
+    }
+    return slot;
+}
+
+void SymbolTable::rehash(std::size_t slotCount) {
+    slots.assign(slotCount, npos);
+    for (Id id = 0; id < names.size(); ++id) {
+        slots[slotOf(names[id])] = id;
+    }
+}
+
+void SymbolTable::reserve(std::size_t symbols) {
+    names.reserve(symbols);
+    std::size_t slotCount = 16;
+    while (slotCount < symbols * 2) slotCount *= 2;
+    if (slotCount > slots.size()) rehash(slotCount);
+}
+
+SymbolTable::Id SymbolTable::intern(std::string_view name) {
+    if (slots.empty()) rehash(16);
+    std::size_t slot = slotOf(name);
+    if (slots[slot] != npos) {
+        return slots[slot];
+    }
+    Id id = static_cast<Id>(names.size());
+    names.push_back(arena.copy(name));
+    slots[slot] = id;
+    // Bezettingsgraad onder 1/2 houden
+    if (names.size() * 2 > slots.size()) rehash(slots.size() * 2);
+    return id;
+}
+
+SymbolTable::Id SymbolTable::find(std::string_view name) const {
+    if (slots.empty()) return npos;
+    std::size_t slot = slotOf(name);
+    return slots[slot];
+}
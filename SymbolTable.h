@@ -0,0 +1,39 @@
+#ifndef SYMBOLTABLE_H
+#define SYMBOLTABLE_H
+
+#include "Arena.h"
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Kent aan elk symbool (variabele of terminal) een dicht 32-bit id toe.
+// Namen worden maar een keer opgeslagen, achter elkaar in een Arena; de lookup is een
+// open-adressering hashtabel van ids, dus geen heap-allocatie per symbool.
+class SymbolTable {
+public:
+    using Id = std::uint32_t;
+    static constexpr Id npos = UINT32_MAX;
+
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable &other);
+    SymbolTable &operator=(const SymbolTable &other);
+    SymbolTable(SymbolTable &&) = default;
+    SymbolTable &operator=(SymbolTable &&) = default;
+
+    Id intern(std::string_view name);
+    Id find(std::string_view name) const;
+
+    std::string_view name(Id id) const { return names[id]; }
+    std::size_t size() const { return names.size(); }
+    void reserve(std::size_t symbols);
+
+private:
+    Arena arena;
+    std::vector<std::string_view> names;  // wijzen in arena
+    std::vector<Id> slots;                // npos = leeg; grootte is een macht van 2
+
+    std::size_t slotOf(std::string_view name) const;
+    void rehash(std::size_t slotCount);
+};
+
+#endif // SYMBOLTABLE_H
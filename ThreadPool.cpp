@@ -0,0 +1,158 @@
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace {
+    // Welke wachtrij hoort bij de huidige thread; andere threads (de eigenaar) gebruiken queue 0
+    thread_local const ThreadPool *currentPool = nullptr;
+    thread_local std::size_t currentQueue = 0;
+}
+
+ThreadPool::ThreadPool(std::size_t threads) {
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (std::size_t i = 0; i < threads; ++i) {
+        queues.push_back(std::make_unique<Queue>());
+    }
+    for (std::size_t i = 1; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(wakeMutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> task, Batch *batch) {
+    Queue &queue = *queues[nextQueue++ % queues.size()];
+    if (batch) ++batch->pending;
+    ++pending;
+    {
+        // Tellen voor de push en onder hetzelfde slot: wie de taak neemt, ziet ze al geteld
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        ++queued;
+        if (batch) ++batch->queued;
+        queue.tasks.push_back({std::move(task), batch});
+    }
+    {
+        // Een worker tussen zijn predicaat en wait() mist de melding zo niet
+        std::lock_guard<std::mutex> lock(wakeMutex);
+    }
+    wake.notify_one();
+    if (batch) {
+        // wait(batch) slaapt tot er een taak van de batch klaarstaat
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done.notify_all();
+    }
+}
+
+std::size_t ThreadPool::ownQueue() const {
+    return currentPool == this ? currentQueue : 0;
+}
+
+bool ThreadPool::runOne(std::size_t self, const Batch *only) {
+    auto matches = [only](const Task &task) { return !only || task.batch == only; };
+    Task task{};
+    for (std::size_t i = 0; i < queues.size() && !task.run; ++i) {
+        Queue &queue = *queues[(self + i) % queues.size()];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (i == 0) {
+            auto it = std::find_if(queue.tasks.begin(), queue.tasks.end(), matches);
+            if (it == queue.tasks.end()) continue;
+            task = std::move(*it);
+            queue.tasks.erase(it);
+        } else {
+            // Stelen gebeurt aan de andere kant van de wachtrij
+            auto it = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(), matches);
+            if (it == queue.tasks.rend()) continue;
+            task = std::move(*it);
+            queue.tasks.erase(std::next(it).base());
+        }
+        --queued;
+        if (task.batch) --task.batch->queued;
+    }
+    if (!task.run) return false;
+
+    try {
+        task.run();
+    } catch (...) {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        std::exception_ptr &first = task.batch ? task.batch->failure : failure;
+        if (!first) first = std::current_exception();
+    }
+    // Na het aftellen kan de wachtende de batch al opruimen: niet meer aanraken
+    const bool batchDone = task.batch && --task.batch->pending == 0;
+    if (--pending == 0 || batchDone) {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        done.notify_all();
+    }
+    return true;
+}
+
+void ThreadPool::workerLoop(std::size_t self) {
+    currentPool = this;
+    currentQueue = self;
+    while (true) {
+        if (runOne(self)) continue;
+        std::unique_lock<std::mutex> lock(wakeMutex);
+        wake.wait(lock, [&] { return stopping || queued > 0; });
+        if (stopping && queued == 0) return;
+    }
+}
+
+void ThreadPool::wait() {
+    while (pending > 0) {
+        if (runOne(ownQueue())) continue;
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait(lock, [&] { return pending == 0 || queued > 0; });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        std::swap(error, failure);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void ThreadPool::wait(Batch &batch) {
+    // Enkel taken van deze batch helpen uitvoeren: een willekeurige lange taak zou de
+    // wachtende (vaak zelf een taak) onnodig lang ophouden. Wat niet meer in een wachtrij
+    // staat, loopt al op een andere thread.
+    while (batch.pending > 0) {
+        if (runOne(ownQueue(), &batch)) continue;
+        std::unique_lock<std::mutex> lock(doneMutex);
+        done.wait(lock, [&] { return batch.pending == 0 || batch.queued > 0; });
+    }
+
+    std::exception_ptr error;
+    {
+        std::lock_guard<std::mutex> lock(doneMutex);
+        std::swap(error, batch.failure);
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+void ThreadPool::parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)> &body,
+                             std::size_t grain) {
+    if (begin >= end) return;
+    // Ongeveer 4 blokken per thread zodat stelen de belasting kan egaliseren
+    std::size_t chunk = std::max(grain, (end - begin + 4 * size() - 1) / (4 * size()));
+    if (size() == 1 || end - begin <= chunk) {
+        for (std::size_t i = begin; i < end; ++i) body(i);
+        return;
+    }
+    Batch batch;
+    for (std::size_t first = begin; first < end; first += chunk) {
+        std::size_t last = std::min(end, first + chunk);
+        submit([&body, first, last] {
+            for (std::size_t i = first; i < last; ++i) body(i);
+        }, &batch);
+    }
+    wait(batch);
+}
@@ -0,0 +1,82 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing thread pool: elke thread heeft een eigen wachtrij en neemt daar vooraan uit;
+// een lege thread steelt achteraan uit de wachtrij van een andere. De thread die wait()
+// oproept helpt mee, dus een pool met 1 thread voert alles inline uit.
+//
+// wait() wacht op alle taken, ook op de taak die het zou oproepen: vanuit een taak dus enkel
+// wait(batch) gebruiken, dat wacht op de taken van die ene Batch (zo doet parallelFor het) en
+// enkel die taken mee uitvoert.
+class ThreadPool {
+public:
+    // Groep taken met een eigen teller; moet blijven bestaan tot wait(batch) terugkeert
+    class Batch {
+        friend class ThreadPool;
+        std::atomic<std::size_t> pending{0};
+        std::atomic<std::size_t> queued{0};  // nog in een wachtrij, onder het slot van die wachtrij
+        std::exception_ptr failure;  // onder doneMutex van de pool
+    };
+
+    explicit ThreadPool(std::size_t threads = 0);  // 0 = std::thread::hardware_concurrency()
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    std::size_t size() const { return queues.size(); }
+
+    void submit(std::function<void()> task, Batch *batch = nullptr);
+    // Tot alle ingediende taken klaar zijn. Gooide een taak, dan lopen de andere gewoon verder
+    // en gooit wait() daarna de eerste uitzondering opnieuw. Niet oproepen vanuit een taak.
+    void wait();
+    // Tot de taken van batch klaar zijn, ook vanuit een taak; gooit de eerste uitzondering
+    // van die taken opnieuw
+    void wait(Batch &batch);
+
+    // Voert body(i) uit voor alle i in [begin, end), in blokken van minstens grain indices.
+    // Wacht enkel op die blokken, dus mag ook vanuit een taak.
+    void parallelFor(std::size_t begin, std::size_t end, const std::function<void(std::size_t)> &body,
+                     std::size_t grain = 1);
+
+private:
+    struct Task {
+        std::function<void()> run;
+        Batch *batch;
+    };
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues;  // queue 0 hoort bij de oproepende thread
+    std::vector<std::thread> workers;
+
+    std::atomic<std::size_t> queued{0};
+    std::atomic<std::size_t> pending{0};
+    std::atomic<std::size_t> nextQueue{0};
+    bool stopping = false;
+
+    std::mutex wakeMutex;
+    std::condition_variable wake;
+    std::mutex doneMutex;
+    std::condition_variable done;
+    std::exception_ptr failure;  // eerste uitzondering uit een taak zonder batch, onder doneMutex
+
+    std::size_t ownQueue() const;  // wachtrij van de oproepende thread
+    bool runOne(std::size_t self, const Batch *only = nullptr);
+    void workerLoop(std::size_t self);
+};
+
+#endif // THREADPOOL_H
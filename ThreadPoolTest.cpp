@@ -0,0 +1,117 @@
+// Stresstest van ThreadPool: geneste parallelFor, wait(batch) vanuit een taak, en uitzonderingen
+// die via de juiste wait terugkomen, telkens voor pools van 1 tot 8 threads en veel rondes, zodat
+// een gemiste wake-up of een fout in het helpen (zie wait(Batch &)) als hang of verkeerde telling
+// opvalt. ctest geeft de test een timeout.
+//
+//   ./PDA2CFG_threadpool_test [rounds]
+#include "ThreadPool.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    int failures = 0;
+
+    void fail(const std::string &message) {
+        std::cerr << "FAIL: " << message << std::endl;
+        ++failures;
+    }
+
+    // Elke (i, j) van een geneste parallelFor precies een keer
+    void nested(ThreadPool &pool, const std::string &label) {
+        constexpr std::size_t outer = 24, inner = 100;
+        std::vector<std::atomic<int>> hits(outer * inner);
+        pool.parallelFor(0, outer, [&](std::size_t i) {
+            pool.parallelFor(0, inner, [&](std::size_t j) { ++hits[i * inner + j]; });
+        });
+        for (std::size_t k = 0; k < hits.size(); ++k) {
+            if (hits[k] != 1) {
+                fail(label + ": nested parallelFor ran (" + std::to_string(k / inner) + ", " +
+                     std::to_string(k % inner) + ") " + std::to_string(hits[k]) + " times");
+                return;
+            }
+        }
+    }
+
+    // Taken zonder batch die elk hun eigen batch indienen en erop wachten, met pool.wait() erboven
+    void waitInsideTask(ThreadPool &pool, const std::string &label) {
+        constexpr int tasks = 16, subtasks = 32;
+        std::atomic<int> done{0};
+        for (int t = 0; t < tasks; ++t) {
+            pool.submit([&] {
+                ThreadPool::Batch batch;
+                std::atomic<int> local{0};
+                for (int s = 0; s < subtasks; ++s) pool.submit([&] { ++local; }, &batch);
+                pool.wait(batch);
+                if (local != subtasks) fail(label + ": wait(batch) returned before its tasks finished");
+                done += local;
+            });
+        }
+        pool.wait();
+        if (done != tasks * subtasks) fail(label + ": " + std::to_string(done) + " subtasks ran");
+    }
+
+    // Een gooiende iteratie, ook diep genest, komt terug uit de buitenste parallelFor; de pool
+    // blijft daarna bruikbaar en een volgende wait gooit niet opnieuw
+    void exceptions(ThreadPool &pool, const std::string &label) {
+        for (std::size_t depth = 0; depth < 2; ++depth) {
+            bool caught = false;
+            try {
+                pool.parallelFor(0, 16, [&](std::size_t i) {
+                    if (depth == 0) {
+                        if (i == 7) throw std::runtime_error("iteration 7");
+                        return;
+                    }
+                    pool.parallelFor(0, 16, [&](std::size_t j) {
+                        if (i == 3 && j == 11) throw std::runtime_error("iteration 3, 11");
+                    });
+                });
+            } catch (const std::runtime_error &) {
+                caught = true;
+            }
+            if (!caught) fail(label + ": exception at depth " + std::to_string(depth) + " was lost");
+        }
+
+        std::atomic<int> ran{0};
+        pool.submit([] { throw std::logic_error("task without batch"); });
+        for (int t = 0; t < 8; ++t) pool.submit([&] { ++ran; });
+        bool caught = false;
+        try {
+            pool.wait();
+        } catch (const std::logic_error &) {
+            caught = true;
+        }
+        if (!caught) fail(label + ": wait() did not rethrow");
+        if (ran != 8) fail(label + ": other tasks did not run after a throwing one");
+        try {
+            pool.wait();
+        } catch (...) {
+            fail(label + ": wait() rethrew an exception twice");
+        }
+        nested(pool, label + " after exceptions");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const int rounds = argc > 1 ? std::atoi(argv[1]) : 200;
+    for (std::size_t threads : {1, 2, 4, 8}) {
+        ThreadPool pool(threads);
+        for (int round = 0; round < rounds; ++round) {
+            const std::string label = std::to_string(threads) + " threads, round " + std::to_string(round);
+            nested(pool, label);
+            waitInsideTask(pool, label);
+            exceptions(pool, label);
+            if (failures > 0) break;
+        }
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " failures" << std::endl;
+        return 1;
+    }
+    std::cout << "ThreadPool survived nested batches and exceptions" << std::endl;
+    return 0;
+}
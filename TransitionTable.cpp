@@ -0,0 +1,55 @@
+#include "TransitionTable.h"
+#include <algorithm>
+#include <tuple>
+
+void TransitionTable::add(std::string_view from, std::string_view input, std::string_view top, std::string_view to,
+                          const std::vector<std::string> &replacement) {
+    Transition t;
+    t.from = states.intern(from);
+    t.input = input.empty() ? epsilon : inputs.intern(input);
+    t.top = stackSymbols.intern(top);
+    t.to = states.intern(to);
+    t.pushBegin = static_cast<std::uint32_t>(pushes.size());
+    for (const auto &symbol : replacement) {
+        pushes.push_back(stackSymbols.intern(symbol));
+    }
+    t.pushEnd = static_cast<std::uint32_t>(pushes.size());
+    transitions.push_back(t);
+}
+
+void TransitionTable::build() {
+    // Epsilon (npos) als -1 behandelen zodat die transities vooraan in hun blok staan
+    auto key = [](const Transition &t) { return std::make_tuple(t.from, t.top, Id(t.input + 1)); };
+    std::stable_sort(transitions.begin(), transitions.end(),
+                     [&](const Transition &a, const Transition &b) { return key(a) < key(b); });
+
+    indexedStacks = stackSymbols.size();
+    offsets.assign(states.size() * indexedStacks + 1, 0);
+    for (const Transition &t : transitions) {
+        ++offsets[t.from * indexedStacks + t.top + 1];
+    }
+    for (std::size_t i = 1; i < offsets.size(); ++i) {
+        offsets[i] += offsets[i - 1];
+    }
+}
+
+TransitionTable::Range TransitionTable::from(Id state, Id top) const {
+    if (state >= states.size() || top >= indexedStacks) return {nullptr, nullptr};
+    std::size_t k = state * indexedStacks + top;
+    return {transitions.data() + offsets[k], transitions.data() + offsets[k + 1]};
+}
+
+TransitionTable::Range TransitionTable::find(Id state, Id input, Id top) const {
+    // Zelfde volgorde als in build(): epsilon + 1 wordt 0
+    struct ByInput {
+        bool operator()(const Transition &t, Id id) const { return Id(t.input + 1) < Id(id + 1); }
+        bool operator()(Id id, const Transition &t) const { return Id(id + 1) < Id(t.input + 1); }
+    };
+    Range block = from(state, top);
+    auto range = std::equal_range(block.first, block.last, input, ByInput());
+    return {range.first, range.second};
+}
+
+std::string_view TransitionTable::inputName(const Transition &t) const {
+    return t.input == epsilon ? std::string_view() : inputs.name(t.input);
+}
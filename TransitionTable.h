@@ -0,0 +1,57 @@
+#ifndef TRANSITIONTABLE_H
+#define TRANSITIONTABLE_H
+
+#include "SymbolTable.h"
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Transities van een PDA met geinterneerde toestanden, inputsymbolen en stapelsymbolen.
+// Na build() staan ze gesorteerd op (toestand, stapeltop, input) in een CSR-layout:
+// alle transities voor (p, X) vormen een aaneengesloten blok, epsilon-transities vooraan.
+class TransitionTable {
+public:
+    using Id = SymbolTable::Id;
+    static constexpr Id epsilon = SymbolTable::npos;  // sorteert als grootste; zie build()
+
+    struct Transition {
+        Id from, input, top, to;
+        std::uint32_t pushBegin, pushEnd;  // vervangende stapelsymbolen, bovenste eerst
+    };
+
+    struct Range {
+        const Transition *first;
+        const Transition *last;
+
+        const Transition *begin() const { return first; }
+        const Transition *end() const { return last; }
+        std::size_t size() const { return static_cast<std::size_t>(last - first); }
+        bool empty() const { return first == last; }
+    };
+
+    SymbolTable states;
+    SymbolTable inputs;
+    SymbolTable stackSymbols;
+
+    void add(std::string_view from, std::string_view input, std::string_view top, std::string_view to,
+             const std::vector<std::string> &replacement);
+    void build();
+
+    std::size_t size() const { return transitions.size(); }
+    Range all() const { return {transitions.data(), transitions.data() + transitions.size()}; }
+    Range from(Id state, Id top) const;               // alle transities voor (p, X)
+    Range find(Id state, Id input, Id top) const;     // enkel deze input (of epsilon)
+
+    std::size_t pushCount(const Transition &t) const { return t.pushEnd - t.pushBegin; }
+    Id push(const Transition &t, std::size_t i) const { return pushes[t.pushBegin + i]; }
+    std::string_view inputName(const Transition &t) const;  // "" voor epsilon
+
+private:
+    std::vector<Transition> transitions;
+    std::vector<Id> pushes;
+    std::vector<std::uint32_t> offsets;  // (p * |stack| + X) -> blok in transitions
+    std::size_t indexedStacks = 0;
+};
+
+#endif // TRANSITIONTABLE_H
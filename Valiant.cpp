@@ -0,0 +1,196 @@
+#include "Valiant.h"
+#include "Bitset.h"
+#include <algorithm>
+#include <chrono>
+#include <tuple>
+
+// Alle matrices van een herkenning: variabele A, rij i = words[(A * size + i) * rowWords, ...)
+struct Valiant::Tables {
+    std::size_t size;
+    std::size_t rowWords;
+    std::vector<std::uint64_t> words;
+    std::vector<std::uint64_t> combinations;  // Four Russians: 256 rij-combinaties van een groep
+
+    std::uint64_t *row(std::uint32_t variable, std::size_t i) { return words.data() + (variable * size + i) * rowWords; }
+};
+
+namespace {
+    // Bits [offset, offset + s) van een woord, of het hele woord als een blok woorden beslaat
+    std::uint64_t blockMask(std::size_t offset, std::size_t s) {
+        return s >= 64 ? ~std::uint64_t(0) : ((std::uint64_t(1) << s) - 1) << (offset % 64);
+    }
+}
+
+Valiant::Valiant(const CFG &cnf) {
+    build(cnf.toGrammar());
+}
+
+Valiant::Valiant(const MappedGrammar &cnf) {
+    build(cnf);
+}
+
+template <typename G>
+void Valiant::build(const G &grammar) {
+    std::vector<std::uint32_t> dense(grammar.symbolCount(), none);
+    for (Grammar::Id id = 0; id < grammar.symbolCount(); ++id) {
+        if (grammar.isVariable(id)) dense[id] = static_cast<std::uint32_t>(variableCount++);
+    }
+    if (grammar.startSymbol != SymbolTable::npos) start = dense[grammar.startSymbol];
+    acceptsEmpty = grammar.acceptsEmpty;
+
+    std::vector<std::pair<unsigned char, std::uint32_t>> terminals;       // (c, A)
+    std::vector<std::tuple<std::uint32_t, std::uint32_t, std::uint32_t>> binary;  // (C, B, A)
+    for (std::size_t p = 0; p < grammar.productionCount(); ++p) {
+        Grammar::Body body = grammar.body(p);
+        std::uint32_t A = dense[grammar.head(p)];
+        if (A == none) continue;  // terminaal als kop: geen regel van een CNF
+        if (body.size() == 1 && !grammar.isVariable(body[0])) {
+            std::string_view terminal = grammar.name(body[0]);
+            if (terminal.size() == 1) terminals.emplace_back(static_cast<unsigned char>(terminal[0]), A);
+        } else if (body.size() == 2 && grammar.isVariable(body[0]) && grammar.isVariable(body[1])) {
+            binary.emplace_back(dense[body[1]], dense[body[0]], A);
+        }
+    }
+
+    std::sort(terminals.begin(), terminals.end());
+    terminals.erase(std::unique(terminals.begin(), terminals.end()), terminals.end());
+    terminalOffsets.assign(257, 0);
+    for (const auto &[c, A] : terminals) {
+        ++terminalOffsets[c + 1];
+        terminalHeads.push_back(A);
+    }
+
+    std::sort(binary.begin(), binary.end());
+    binary.erase(std::unique(binary.begin(), binary.end()), binary.end());
+    rightOffsets.assign(variableCount + 1, 0);
+    for (const auto &[C, B, A] : binary) {
+        ++rightOffsets[C + 1];
+        rules.push_back({B, A});
+    }
+    for (std::size_t i = 1; i < terminalOffsets.size(); ++i) terminalOffsets[i] += terminalOffsets[i - 1];
+    for (std::size_t i = 1; i < rightOffsets.size(); ++i) rightOffsets[i] += rightOffsets[i - 1];
+}
+
+void Valiant::multiply(Tables &tables, std::size_t x, std::size_t y, std::size_t z, std::size_t s) const {
+    const std::uint64_t yMask = blockMask(y, s);
+    const std::uint64_t zMask = blockMask(z, s);
+    const std::size_t yWords = (s + 63) / 64;
+    const std::size_t zWords = yWords;
+    const std::size_t yFirst = y / 64;
+    const std::size_t zFirst = z / 64;
+
+    for (std::uint32_t C = 0; C < variableCount; ++C) {
+        if (rightOffsets[C] == rightOffsets[C + 1]) continue;
+
+        if (s >= fourRussiansMin) {
+            // Per groep van 8 rijen k: alle 256 OR-combinaties, daarna een opzoeking per rij i.
+            // Rijen zijn hier minstens 4 woorden: OR en any via de SIMD-kernels.
+            std::uint64_t *table = tables.combinations.data();
+            for (std::size_t group = y; group < y + s; group += 8) {
+                bool any = false;
+                for (std::size_t k = group; k < group + 8 && !any; ++k) {
+                    any = BitWords<0>::any(tables.row(C, k) + zFirst, zWords);
+                }
+                if (!any) continue;
+                std::fill(table, table + zWords, 0);
+                for (unsigned b = 1; b < 256; ++b) {
+                    const std::uint64_t *low = table + (b & (b - 1)) * zWords;
+                    std::uint64_t *target = std::copy(low, low + zWords, table + b * zWords) - zWords;
+                    BitWords<0>::orInto(target, tables.row(C, group + __builtin_ctz(b)) + zFirst, zWords);
+                }
+                for (std::uint32_t r = rightOffsets[C]; r < rightOffsets[C + 1]; ++r) {
+                    for (std::size_t i = x; i < x + s; ++i) {
+                        const unsigned byte = tables.row(rules[r].left, i)[group / 64] >> (group % 64) & 0xff;
+                        if (!byte) continue;
+                        BitWords<0>::orInto(tables.row(rules[r].head, i) + zFirst, table + byte * zWords, zWords);
+                    }
+                }
+            }
+            continue;
+        }
+
+        // Leeg blok T_C[y.., z..]: geen enkele regel met deze C draagt bij
+        bool empty = true;
+        for (std::size_t k = y; k < y + s && empty; ++k) {
+            const std::uint64_t *right = tables.row(C, k) + zFirst;
+            for (std::size_t w = 0; w < zWords; ++w) {
+                if (right[w] & zMask) {
+                    empty = false;
+                    break;
+                }
+            }
+        }
+        if (empty) continue;
+
+        // Rij per rij: voor elke k met T_B[i][k] de rij k van T_C bij T_A[i] OR'en
+        for (std::uint32_t r = rightOffsets[C]; r < rightOffsets[C + 1]; ++r) {
+            for (std::size_t i = x; i < x + s; ++i) {
+                const std::uint64_t *left = tables.row(rules[r].left, i) + yFirst;
+                std::uint64_t *target = tables.row(rules[r].head, i) + zFirst;
+                for (std::size_t v = 0; v < yWords; ++v) {
+                    for (std::uint64_t word = left[v] & yMask; word; word &= word - 1) {
+                        const std::size_t k = (yFirst + v) * 64 + __builtin_ctzll(word);
+                        const std::uint64_t *right = tables.row(C, k) + zFirst;
+                        for (std::size_t w = 0; w < zWords; ++w) target[w] |= right[w] & zMask;
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Alle cellen met i in [l, m) en j in [l2, m2), gegeven alle cellen binnen beide blokken en
+// alle splitsingen k in [m, l2) (Okhotin, procedure complete)
+void Valiant::complete(Tables &tables, std::size_t l, std::size_t m, std::size_t l2, std::size_t m2) const {
+    const std::size_t s = m - l;
+    if (s == 1) return;  // de producten zitten al in T; een cel van lengte 1 is een terminal
+    const std::size_t half = s / 2;
+    const std::size_t mid = l + half, mid2 = l2 + half;
+
+    complete(tables, mid, m, l2, mid2);
+    multiply(tables, l, mid, l2, half);    // B1 x B1' via k in B2
+    complete(tables, l, mid, l2, mid2);
+    multiply(tables, mid, l2, mid2, half);  // B2 x B2' via k in B1'
+    complete(tables, mid, m, mid2, m2);
+    multiply(tables, l, mid, mid2, half);   // B1 x B2' via k in B2
+    multiply(tables, l, l2, mid2, half);    // B1 x B2' via k in B1'
+    complete(tables, l, mid, mid2, m2);
+}
+
+// Alle cellen binnen [l, m)
+void Valiant::compute(Tables &tables, std::size_t l, std::size_t m) const {
+    const std::size_t mid = l + (m - l) / 2;
+    if (m - l >= 4) {
+        compute(tables, l, mid);
+        compute(tables, mid, m);
+    }
+    complete(tables, l, mid, mid, m);
+}
+
+Valiant::Run Valiant::run(const std::string &input) const {
+    auto begin = std::chrono::steady_clock::now();
+    const std::size_t n = input.size();
+    bool accepted = n == 0 && acceptsEmpty;
+
+    if (n > 0 && start != none) {
+        // Posities 0..n, aangevuld tot een macht van 2; lege cellen voorbij n storen niet
+        std::size_t size = 2;
+        while (size < n + 1) size *= 2;
+        Tables tables{size, (size + 63) / 64, {}, {}};
+        tables.words.assign(variableCount * size * tables.rowWords, 0);
+        if (size >= fourRussiansMin) tables.combinations.assign(256 * tables.rowWords, 0);
+
+        for (std::size_t i = 0; i < n; ++i) {
+            const unsigned char c = static_cast<unsigned char>(input[i]);
+            for (std::uint32_t t = terminalOffsets[c]; t < terminalOffsets[c + 1]; ++t) {
+                tables.row(terminalHeads[t], i)[(i + 1) / 64] |= std::uint64_t(1) << ((i + 1) % 64);
+            }
+        }
+
+        compute(tables, 0, size);
+        accepted = tables.row(start, 0)[n / 64] >> (n % 64) & 1;
+    }
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+    return {accepted, elapsed.count()};
+}
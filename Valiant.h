@@ -0,0 +1,56 @@
+#ifndef VALIANT_H
+#define VALIANT_H
+
+#include "CFG.h"
+#include "GrammarBinary.h"
+#include "Recognizer.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Herkenner voor een grammatica in Chomsky-normaalvorm volgens Valiant, in de vorm van
+// Okhotin (2014): de CYK-tabel wordt blok per blok gevuld met booleaanse matrixproducten
+// in plaats van cel per cel. Per variabele A is er een bitmatrix T_A (rij i, kolom j:
+// A =>* input[i, j)), rijen gepakt in 64-bit woorden; elk product T_B x T_C wordt meteen
+// in T_A ge-OR'd voor alle regels A -> B C. Grote blokken vermenigvuldigen met Four Russians
+// (tabel van 256 rij-combinaties per groep van 8 rijen).
+// Geheugen: |V| * D^2 bits met D de kleinste macht van 2 boven de invoerlengte.
+// De lege invoer wordt, zoals bij CYK, beantwoord met Grammar::acceptsEmpty.
+class Valiant {
+public:
+    using Run = RecognitionRun;
+
+    explicit Valiant(const CFG &cnf);
+    explicit Valiant(const MappedGrammar &cnf);
+
+    bool accepts(const std::string &input) const { return run(input).accepted; }
+    Run run(const std::string &input) const;
+
+private:
+    struct Rule {
+        std::uint32_t left;  // B in A -> B C
+        std::uint32_t head;  // A
+    };
+    struct Tables;
+
+    static constexpr std::uint32_t none = UINT32_MAX;
+    static constexpr std::size_t fourRussiansMin = 256;  // kleinere blokken: rij per rij OR'en
+
+    template <typename G>
+    void build(const G &grammar);
+
+    void compute(Tables &tables, std::size_t l, std::size_t m) const;
+    void complete(Tables &tables, std::size_t l, std::size_t m, std::size_t l2, std::size_t m2) const;
+    // T_A[x.., z..] |= T_B[x.., y..] * T_C[y.., z..] voor alle regels, blokken van s x s
+    void multiply(Tables &tables, std::size_t x, std::size_t y, std::size_t z, std::size_t s) const;
+
+    std::size_t variableCount = 0;
+    std::uint32_t start = none;
+    bool acceptsEmpty = false;
+    std::vector<std::uint32_t> terminalOffsets;  // teken c: terminalHeads[terminalOffsets[c], terminalOffsets[c+1])
+    std::vector<std::uint32_t> terminalHeads;
+    std::vector<std::uint32_t> rightOffsets;     // C: rules[rightOffsets[C], rightOffsets[C+1])
+    std::vector<Rule> rules;
+};
+
+#endif // VALIANT_H
@@ -0,0 +1,173 @@
+// Benchmarks voor de conversie-pipeline op synthetische PDA's.
+// Elke scenario genereert een PDA met een vaste seed (dus reproduceerbaar), en meet de mediaan
+// over --repeat herhalingen van: inlezen, PDA::toCFG (volledig en gesnoeid), elke toCNF-pass
+// op de gesnoeide grammatica en CFG::print van de volledige grammatica.
+
+#include "PDA.h"
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <random>
+#include <sstream>
+
+using namespace std;
+
+namespace {
+    struct Scenario {
+        string name;
+        size_t states;        // aantal toestanden
+        size_t stackSymbols;  // aantal stapelsymbolen (naast Z0)
+        size_t transitions;
+        size_t pushDepth;     // maximale lengte van een replacement (de triple-constructie kent 0..2)
+        double epsilon;       // kans op een epsilon-input
+        bool adversarial;     // elke (toestand, stapelsymbool) krijgt epsilon-transities die 2 symbolen pushen
+    };
+
+    // Willekeurige PDA als JSON in het formaat van het invoerbestand
+    string generate(const Scenario &scenario, unsigned seed) {
+        mt19937 rng(seed);
+        auto pick = [&](size_t n) { return static_cast<size_t>(rng() % n); };
+        auto state = [](size_t i) { return "q" + to_string(i); };
+        auto stack = [](size_t i) { return i == 0 ? string("Z0") : "X" + to_string(i); };
+        const size_t stackCount = scenario.stackSymbols + 1;
+        bernoulli_distribution epsilon(scenario.epsilon);
+
+        ostringstream out;
+        out << "{\"States\": [";
+        for (size_t i = 0; i < scenario.states; ++i) out << (i ? ", " : "") << '"' << state(i) << '"';
+        out << "], \"Alphabet\": [\"a\", \"b\"], \"StackAlphabet\": [";
+        for (size_t i = 0; i < stackCount; ++i) out << (i ? ", " : "") << '"' << stack(i) << '"';
+        out << "], \"Transitions\": [";
+
+        bool first = true;
+        auto transition = [&](size_t from, const string &input, size_t top, size_t to, const vector<size_t> &push) {
+            out << (first ? "" : ", ") << "{\"from\": \"" << state(from) << "\", \"input\": \"" << input
+                << "\", \"stacktop\": \"" << stack(top) << "\", \"to\": \"" << state(to) << "\", \"replacement\": [";
+            for (size_t i = 0; i < push.size(); ++i) out << (i ? ", " : "") << '"' << stack(push[i]) << '"';
+            out << "]}";
+            first = false;
+        };
+
+        const size_t depth = min<size_t>(scenario.pushDepth, 2);
+        if (scenario.adversarial) {
+            // Dichtste geval voor de constructie: |Q|^2 producties per transitie, veel nullables
+            for (size_t p = 0; p < scenario.states; ++p) {
+                for (size_t X = 0; X < stackCount; ++X) {
+                    transition(p, "", X, pick(scenario.states), {pick(stackCount), pick(stackCount)});
+                    transition(p, rng() % 2 ? "a" : "b", X, pick(scenario.states), {});
+                }
+            }
+        }
+        // Elke toestand kan Z0 poppen, zodat de taal zelden leeg is
+        for (size_t p = 0; p < scenario.states; ++p) {
+            transition(p, epsilon(rng) ? "" : (rng() % 2 ? "a" : "b"), 0, pick(scenario.states), {});
+        }
+        for (size_t i = 0; i < scenario.transitions; ++i) {
+            vector<size_t> push(pick(depth + 1));
+            for (auto &symbol : push) symbol = pick(stackCount);
+            string input = epsilon(rng) ? "" : (rng() % 2 ? "a" : "b");
+            transition(pick(scenario.states), input, pick(stackCount), pick(scenario.states), push);
+        }
+        out << "], \"StartState\": \"q0\", \"StartStack\": \"Z0\"}";
+        return out.str();
+    }
+
+    double median(vector<double> samples) {
+        sort(samples.begin(), samples.end());
+        return samples[samples.size() / 2];
+    }
+
+    template <typename F>
+    double seconds(F f) {
+        auto begin = chrono::steady_clock::now();
+        f();
+        return chrono::duration<double>(chrono::steady_clock::now() - begin).count();
+    }
+
+    void report(const string &scenario, const string &stage, const vector<double> &samples, size_t productions) {
+        cout << "bench scenario=" << scenario << " stage=" << stage << " median_ms=" << fixed << setprecision(3)
+             << median(samples) * 1000 << defaultfloat << " productions=" << productions << endl;
+    }
+
+    void run(const Scenario &scenario, size_t repeat, unsigned seed) {
+        const string json = generate(scenario, seed);
+        vector<double> load, full, pruned, print;
+        map<string, vector<double>> passes;
+        vector<string> passOrder;
+        size_t fullCount = 0, prunedCount = 0;
+        map<string, size_t> passCount;
+
+        for (size_t r = 0; r < repeat; ++r) {
+            istringstream input(json);
+            unique_ptr<PDA> pda;
+            load.push_back(seconds([&] { pda = make_unique<PDA>(input); }));
+
+            CFG cfg;
+            full.push_back(seconds([&] { cfg = pda->toCFG(); }));
+            fullCount = cfg.productionCount();
+
+            CFG cnf;
+            pruned.push_back(seconds([&] { cnf = pda->toCFG(true); }));
+            prunedCount = cnf.productionCount();
+
+            for (const auto &entry : cnf.toCNF(Verbosity::Silent)) {
+                if (r == 0) passOrder.push_back(entry.pass);
+                passes[entry.pass].push_back(entry.seconds);
+                passCount[entry.pass] = entry.productionsOut;
+            }
+
+            OutputSink sink("/dev/null");
+            print.push_back(seconds([&] { cfg.print(sink); }));
+        }
+
+        report(scenario.name, "load", load, 0);
+        report(scenario.name, "toCFG", full, fullCount);
+        report(scenario.name, "toCFG-pruned", pruned, prunedCount);
+        for (const auto &pass : passOrder) {
+            report(scenario.name, "cnf-" + pass, passes[pass], passCount[pass]);
+        }
+        report(scenario.name, "print", print, fullCount);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    // naam, |Q|, |Gamma|, transities, push-diepte, epsilon-kans, adversarieel
+    vector<Scenario> scenarios = {
+            {"small", 4, 2, 20, 2, 0.2, false},
+            {"medium", 16, 4, 200, 2, 0.2, false},
+            {"large", 40, 6, 400, 2, 0.2, false},
+            {"epsilon-heavy", 10, 3, 120, 2, 0.8, false},
+            {"shallow", 24, 3, 300, 1, 0.2, false},
+            {"adversarial", 20, 4, 0, 2, 1.0, true},
+    };
+
+    size_t repeat = 5;
+    unsigned seed = 1;
+    string only;  // --scenario <naam>: enkel dit scenario
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--repeat" && i + 1 < argc) {
+            repeat = max<size_t>(1, stoul(argv[++i]));
+        } else if (arg == "--seed" && i + 1 < argc) {
+            seed = static_cast<unsigned>(stoul(argv[++i]));
+        } else if (arg == "--scenario" && i + 1 < argc) {
+            only = argv[++i];
+        } else if (arg == "--custom" && i + 5 < argc) {
+            // --custom <|Q|> <|Gamma|> <transities> <push-diepte> <epsilon-kans>
+            Scenario custom{"custom", stoul(argv[i + 1]), stoul(argv[i + 2]), stoul(argv[i + 3]),
+                            stoul(argv[i + 4]), stod(argv[i + 5]), false};
+            scenarios = {custom};
+            i += 5;
+        } else {
+            cerr << "Usage: " << argv[0] << " [--repeat n] [--seed s] [--scenario name]"
+                 << " [--custom states stack transitions depth epsilon]" << endl;
+            return 1;
+        }
+    }
+
+    for (const auto &scenario : scenarios) {
+        if (!only.empty() && scenario.name != only) continue;
+        run(scenario, repeat, seed);
+    }
+    return 0;
+}
@@ -1,9 +1,276 @@
 #include "PDA.h"
+#include "ConversionCache.h"
+#include "ConversionServer.h"
+#include "CYK.h"
+#include "Earley.h"
+#include "Valiant.h"
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
 
 using namespace std;
 
-int main() {
-    PDA pda("input-pda2cfg1.json");
-    pda.toCFG().print();
+static string extensionFor(const string &format) {
+    if (format == "json") return ".cfg.json";
+    if (format == "jsonl") return ".cfg.jsonl";
+    if (format == "binary") return ".cfg.bin";
+    return ".cfg.txt";
+}
+
+// Bestanden voor --batch: alle *.json in een map, of een manifest met een pad per regel
+// (relatief t.o.v. de map van het manifest)
+static vector<filesystem::path> batchInputs(const filesystem::path &source) {
+    vector<filesystem::path> inputs;
+    if (filesystem::is_directory(source)) {
+        for (const auto &entry : filesystem::directory_iterator(source)) {
+            // Eigen uitvoer (*.cfg.json) overslaan zodat een map opnieuw verwerkt kan worden
+            const filesystem::path &path = entry.path();
+            if (entry.is_regular_file() && path.extension() == ".json" && path.stem().extension() != ".cfg") {
+                inputs.push_back(path);
+            }
+        }
+        sort(inputs.begin(), inputs.end());
+        return inputs;
+    }
+
+    ifstream manifest(source);
+    if (!manifest) {
+        cerr << "Could not open file " << source.string() << endl;
+        exit(1);
+    }
+    string line;
+    while (getline(manifest, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        filesystem::path path(line);
+        inputs.push_back(path.is_absolute() ? path : source.parent_path() / path);
+    }
+    return inputs;
+}
+
+// Een bestand omzetten; gooit bij een fout in plaats van te stoppen, zodat de rest doorgaat
+static void convertFile(const filesystem::path &input, const filesystem::path &target, const string &format,
+                        bool pruned, const ConversionCache *cache) {
+    ifstream stream(input);
+    if (!stream) throw runtime_error("could not open file");
+    PDA pda(stream);
+    CFG cfg = convertPDA(pda, pruned, nullptr, cache);
+
+    FILE *file = fopen(target.string().c_str(), "wb");
+    if (!file) throw runtime_error("could not write " + target.string());
+    {
+        OutputSink out(file);
+        cfg.write(out, format);
+    }
+    const bool written = ferror(file) == 0;
+    if (fclose(file) != 0 || !written) throw runtime_error("could not write " + target.string());
+}
+
+// Geeft het aantal mislukte bestanden terug; die worden gemeld en de andere gaan door
+static size_t runBatch(const filesystem::path &source, const string &outDir, const string &format, bool pruned,
+                       size_t threads, const ConversionCache *cache) {
+    auto begin = chrono::steady_clock::now();
+    vector<filesystem::path> inputs = batchInputs(source);
+    if (!outDir.empty()) filesystem::create_directories(outDir);
+
+    atomic<size_t> failed{0};
+    mutex errorMutex;
+    ThreadPool pool(threads);
+    for (const auto &input : inputs) {
+        pool.submit([&, input] {
+            filesystem::path target = outDir.empty() ? input.parent_path() : filesystem::path(outDir);
+            target /= input.stem().string() + extensionFor(format);
+            try {
+                convertFile(input, target, format, pruned, cache);
+            } catch (const exception &error) {
+                ++failed;
+                lock_guard<mutex> lock(errorMutex);
+                cerr << input.string() << ": " << error.what() << endl;
+            }
+        });
+    }
+    pool.wait();
+
+    chrono::duration<double> elapsed = chrono::steady_clock::now() - begin;
+    cout << "Converted " << inputs.size() - failed << " files in " << elapsed.count() << " s";
+    if (failed > 0) cout << ", " << failed << " failed";
+    cout << endl;
+    return failed;
+}
+
+static void printRun(const string &word, const RecognitionRun &run) {
+    cout << "`" << word << "`: " << (run.accepted ? "accepted" : "rejected")
+         << " (" << word.size() << " chars, " << run.charsPerSecond(word.size()) << " chars/s)" << endl;
+}
+
+// Woorden van --cyk op een CNF-grammatica, met CYK of (--valiant) met matrixvermenigvuldiging
+template <typename G>
+static void runCYK(const G &cnf, const vector<string> &words, size_t threads, bool valiant) {
+    if (valiant) {
+        Valiant recognizer(cnf);
+        for (const auto &word : words) printRun(word, recognizer.run(word));
+        return;
+    }
+    CYK cyk(cnf);
+    ThreadPool pool(threads);
+    for (const auto &word : words) printRun(word, cyk.run(word, pool.size() > 1 ? &pool : nullptr));
+}
+
+// --threads <n>: enkel een positief geheel getal, anders een foutmelding en exit(1)
+static size_t parseThreads(const string &value) {
+    size_t threads = 0;
+    if (!value.empty() && value.find_first_not_of("0123456789") == string::npos) {
+        try {
+            threads = stoul(value);
+        } catch (const out_of_range &) {
+            threads = 0;
+        }
+    }
+    if (threads == 0) {
+        cerr << "--threads expects a positive number of threads, got '" << value << "'" << endl;
+        exit(1);
+    }
+    return threads;
+}
+
+int main(int argc, char *argv[]) {
+    string filename = "input-pda2cfg1.json";
+    vector<string> words;      // --cyk <woord>: lidmaatschap testen op de CNF-grammatica
+    vector<string> simulated;  // --accepts <woord>: lidmaatschap via directe PDA-simulatie
+    vector<string> earley;     // --earley <woord>: lidmaatschap op de grammatica zelf, zonder CNF
+    size_t threads = 1;        // --threads <n>: n >= 1
+    bool threadsGiven = false; // zonder --threads gebruikt --batch alle cores
+    string output;             // -o <bestand>: grammatica naar een bestand i.p.v. stdout
+    string format = "text";    // --format text|json|jsonl|binary
+    string saveCNF;            // --save-cnf <bestand>: CNF-grammatica binair bewaren
+    string loadCNF;            // --load-cnf <bestand>: binaire grammatica mappen i.p.v. converteren
+    string batch;              // --batch <map|manifest>: veel PDA's tegelijk converteren
+    string outDir;             // --out-dir <map>: uitvoermap voor --batch
+    bool pruned = false;       // --pruned: enkel bereikbare en productieve triples
+    bool valiant = false;      // --valiant: --cyk via Valiants matrixalgoritme
+    string cacheDir;           // --cache <map>: conversies bewaren en hergebruiken op inhoud van de PDA
+    string socket;             // --serve <socket>: als server conversies afhandelen, zie ConversionServer.h
+    Verbosity verbosity = Verbosity::Report;  // --quiet / --verbose: logging van toCNF
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "--cyk" && i + 1 < argc) {
+            words.push_back(argv[++i]);
+        } else if (arg == "--accepts" && i + 1 < argc) {
+            simulated.push_back(argv[++i]);
+        } else if (arg == "--earley" && i + 1 < argc) {
+            earley.push_back(argv[++i]);
+        } else if (arg == "--format" && i + 1 < argc) {
+            format = argv[++i];
+        } else if (arg == "-o" && i + 1 < argc) {
+            output = argv[++i];
+        } else if (arg == "--threads" && i + 1 < argc) {
+            threads = parseThreads(argv[++i]);
+            threadsGiven = true;
+        } else if (arg == "--save-cnf" && i + 1 < argc) {
+            saveCNF = argv[++i];
+        } else if (arg == "--load-cnf" && i + 1 < argc) {
+            loadCNF = argv[++i];
+        } else if (arg == "--batch" && i + 1 < argc) {
+            batch = argv[++i];
+        } else if (arg == "--out-dir" && i + 1 < argc) {
+            outDir = argv[++i];
+        } else if (arg == "--pruned") {
+            pruned = true;
+        } else if (arg == "--valiant") {
+            valiant = true;
+        } else if (arg == "--cache" && i + 1 < argc) {
+            cacheDir = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            socket = argv[++i];
+        } else if (arg == "--quiet") {
+            verbosity = Verbosity::Silent;
+        } else if (arg == "--verbose") {
+            verbosity = Verbosity::Trace;
+        } else {
+            filename = arg;
+        }
+    }
+
+    unique_ptr<ConversionCache> cache = cacheDir.empty() ? nullptr : make_unique<ConversionCache>(cacheDir);
+
+    if (!socket.empty()) {
+        // --threads geeft het aantal workers
+        ConversionServer server(socket, threads, cache.get());
+        return server.run();
+    }
+
+    if (!batch.empty()) {
+        return runBatch(batch, outDir, format, pruned, threadsGiven ? threads : 0, cache.get()) > 0 ? 1 : 0;
+    }
+
+    if (!loadCNF.empty()) {
+        // Zonder PDA of conversie; zonder --cyk of --earley de grammatica zelf uitschrijven
+        MappedGrammar cnf(loadCNF);
+        if (!earley.empty()) {
+            Earley recognizer(cnf.toGrammar());
+            for (const auto &word : earley) printRun(word, recognizer.run(word));
+        }
+        if (!words.empty()) runCYK(cnf, words, threads, valiant);
+        if (words.empty() && earley.empty()) {
+            unique_ptr<OutputSink> out = output.empty() ? make_unique<OutputSink>(stdout) : make_unique<OutputSink>(output);
+            CFG(cnf).write(*out, format);
+            if (!out->close()) return 1;  // de fout is al gemeld
+        }
+        return 0;
+    }
+
+    PDA pda(filename);
+    for (const auto &word : simulated) {
+        try {
+            cout << "`" << word << "`: " << (pda.accepts(word) ? "accepted" : "rejected") << endl;
+        } catch (const length_error &error) {
+            cerr << filename << ": " << error.what() << endl;
+            exit(1);
+        }
+    }
+    if (!earley.empty()) {
+        Earley recognizer(pda.toCFG(true));
+        for (const auto &word : earley) printRun(word, recognizer.run(word));
+    }
+    if ((!simulated.empty() || !earley.empty()) && words.empty() && saveCNF.empty()) return 0;
+
+    if (words.empty() && saveCNF.empty()) {
+        unique_ptr<OutputSink> out = output.empty() ? make_unique<OutputSink>(stdout) : make_unique<OutputSink>(output);
+        ThreadPool pool(threads);
+        convertPDA(pda, pruned, pool.size() > 1 ? &pool : nullptr, cache.get()).write(*out, format);
+        return out->close() ? 0 : 1;
+    }
+
+    Fingerprint key;
+    if (cache) {
+        key = pda.fingerprint();
+        if (auto hit = cache->find(key, "cnf")) {
+            if (verbosity != Verbosity::Silent) cout << "cnf cache=hit key=" << key.hex() << endl;
+            if (!saveCNF.empty()) {
+                OutputSink out(saveCNF);
+                writeGrammarBinary(hit->toGrammar(), out);
+                if (!out.close()) return 1;
+            }
+            runCYK(*hit, words, threads, valiant);
+            return 0;
+        }
+    }
+
+    CFG cnf = pda.toCFG(true);  // canoniek: met of zonder --cache dezelfde CNF
+    try {
+        cnf.toCNF(verbosity);
+    } catch (const length_error &error) {
+        cerr << filename << ": " << error.what() << endl;
+        exit(1);
+    }
+    if (cache) cache->store(key, "cnf", cnf.toGrammar());
+    if (!saveCNF.empty()) {
+        OutputSink out(saveCNF);
+        cnf.writeBinary(out);
+        if (!out.close()) return 1;
+    }
+    runCYK(cnf, words, threads, valiant);
     return 0;
-}
\ No newline at end of file
+}